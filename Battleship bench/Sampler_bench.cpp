@@ -0,0 +1,133 @@
+// Benchmark of fleet layout samplers
+
+//------------------------------------------------------------------------------
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "GameEngine/Sampler.h"
+#include "GameEngine/Enumerator.h"
+using namespace Game_engine;
+
+//------------------------------------------------------------------------------
+
+// Determines greatest absolute z-score of cell occupancy observed in obs against exact expectation;
+// each cell is covered by at most one ship of layout, so its occupancy is binomial; infinity if cell
+// which is always (or never) occupied is observed otherwise
+// Note: occupancies of cells are correlated (each layout covers the same number of cells), so they
+// aren't summed into chi-square statistic with cells - 1 degrees of freedom
+double max_z_score(const std::vector<unsigned long long>& obs, const std::vector<unsigned long long>& exact,
+	unsigned long long layouts, unsigned long long samples)
+{
+	double max_z = 0;
+	for (unsigned int i = 0; i < obs.size(); ++i) {
+		const double p = static_cast<double>(exact[i]) / layouts;		// Probability of occupancy
+		const double diff = static_cast<double>(obs[i]) - p * samples;
+		const double var = p * (1 - p) * samples;
+		if (var > 0)
+			max_z = std::max(max_z, std::abs(diff) / std::sqrt(var));
+		else if (diff != 0)
+			return std::numeric_limits<double>::infinity();
+	}
+	return max_z;
+}
+
+// Determines critical value of greatest of num absolute z-scores at significance level 0.001;
+// Bonferroni correction keeps level for correlated scores too
+double z_critical(unsigned int num)
+{
+	const double alpha = 0.001 / num;		// Two-sided level of each score
+	double lo = 0, hi = 40;
+	for (unsigned int i = 0; i < 100; ++i) {	// Bisection of P(|z| > x) = erfc(x / sqrt(2)) = alpha
+		const double mid = (lo + hi) / 2;
+		(std::erfc(mid / std::sqrt(2.0)) > alpha ? lo : hi) = mid;
+	}
+	return hi;
+}
+
+//------------------------------------------------------------------------------
+
+// Adds cells of layout res of ships of lengths lens to occupancy counts of cells
+void add_occupancy(const Placement& plc, const std::vector<unsigned int>& lens,
+	const std::vector<Ship_position>& res, std::vector<unsigned long long>& cells)
+{
+	for (unsigned int i = 0; i < lens.size(); ++i)
+		for (Bitboard rest = plc.cells(lens[i], res[i].orient, res[i].anchor); rest.any(); rest.reset(rest.front()))
+			++cells[rest.front()];
+}
+
+// Measures speed of uniform sampler and of sequential placement for ships of lengths lens on field cols * rows
+void bench_speed(unsigned int cols, unsigned int rows, const std::vector<unsigned int>& lens, unsigned int samples)
+{
+	using Clock = std::chrono::steady_clock;
+	const Placement plc{ cols, rows };
+	Placement::Engine ran{ 2020 };
+	std::vector<Ship_position> res;
+	auto start = Clock::now();
+	const Layout_sampler sampler{ plc, lens };
+	const double setup = std::chrono::duration<double>(Clock::now() - start).count();
+	unsigned long long attempts = 0;
+	start = Clock::now();
+	for (unsigned int i = 0; i < samples; ++i)
+		sampler.sample(res, ran, &attempts);
+	const double uniform = std::chrono::duration<double>(Clock::now() - start).count();
+	start = Clock::now();
+	for (unsigned int i = 0; i < samples; ++i)
+		plc.random_layout(lens, res, ran);
+	const double sequential = std::chrono::duration<double>(Clock::now() - start).count();
+	std::cout << "Field " << cols << 'x' << rows << ", " << lens.size() << " ships, " << samples << " samples\n"
+		<< "  uniform sampler:     " << std::setw(12) << samples / uniform << " samples/s, setup " << setup
+		<< " s, acceptance " << static_cast<double>(samples) / attempts << '\n'
+		<< "  sequential placement:" << std::setw(12) << samples / sequential << " samples/s (biased)\n";
+}
+
+// Checks uniformity of samplers for ships of lengths lens on field cols * rows against exact cell occupancy
+void bench_uniformity(unsigned int cols, unsigned int rows, const std::vector<unsigned int>& lens, unsigned int samples)
+{
+	const Placement plc{ cols, rows };
+	Placement::Engine ran{ 2021 };
+	std::vector<Ship_position> res;
+	std::vector<unsigned long long> uniform(cols * rows, 0), sequential(cols * rows, 0);
+	const Layout_count count = Layout_enumerator{ plc, lens }.run();
+	const std::vector<unsigned long long>& exact = count.cells;
+	const unsigned long long layouts = count.layouts;
+	const Layout_sampler sampler{ plc, lens };
+	for (unsigned int i = 0; i < samples; ++i) {
+		sampler.sample(res, ran);
+		add_occupancy(plc, lens, res, uniform);
+		plc.random_layout(lens, res, ran);
+		add_occupancy(plc, lens, res, sequential);
+	}
+	const double crit = z_critical(cols * rows);
+	const double z_uni = max_z_score(uniform, exact, layouts, samples);
+	const double z_seq = max_z_score(sequential, exact, layouts, samples);
+	std::cout << "Field " << cols << 'x' << rows << ", " << lens.size() << " ships, " << layouts << " layouts, "
+		<< samples << " samples, critical max |z| of cells (Bonferroni, p = 0.001) " << crit << '\n'
+		<< "  uniform sampler:      max |z| " << std::setw(12) << z_uni << (z_uni < crit ? "  pass" : "  FAIL") << '\n'
+		<< "  sequential placement: max |z| " << std::setw(12) << z_seq << (z_seq < crit ? "  pass" : "  biased") << '\n';
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+try {
+	// Number of samples may be passed as first argument
+	const unsigned int samples = argc > 1 ? static_cast<unsigned int>(std::stoul(argv[1])) : 100000;
+	const std::vector<unsigned int> classic{ 4, 3, 3, 2, 2, 2, 1, 1, 1, 1 };	// Classic fleet
+	bench_speed(10, 10, classic, samples);
+	// Exact occupancy of classic fleet takes hours to count, so uniformity is checked on smaller fleets
+	bench_uniformity(6, 6, { 3, 2, 2, 1, 1, 1 }, samples);
+	bench_uniformity(7, 7, { 4, 3, 2, 2, 1, 1 }, samples);
+	return 0;
+}
+catch (const std::exception& e) {
+	std::cerr << "Error: " << e.what() << '\n';
+	return 1;
+}
+
+//------------------------------------------------------------------------------
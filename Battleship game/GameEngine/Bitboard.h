@@ -0,0 +1,144 @@
+// Bitboard of game field
+
+//------------------------------------------------------------------------------
+
+#pragma once
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+//------------------------------------------------------------------------------
+
+namespace Game_engine {
+
+	//------------------------------------------------------------------------------
+
+	// Determines number of set bits in v
+	inline unsigned int popcount(std::uint64_t v)
+	{
+#if defined(__GNUC__) && defined(__POPCNT__)
+		return static_cast<unsigned int>(__builtin_popcountll(v));
+#elif defined(_MSC_VER) && defined(_M_X64)
+		return static_cast<unsigned int>(__popcnt64(v));
+#else
+		v = v - ((v >> 1) & 0x5555555555555555ull);
+		v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+		v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+		return static_cast<unsigned int>((v * 0x0101010101010101ull) >> 56);
+#endif
+	}
+
+	// Determines index of lowest set bit in v; v must be non-zero
+	inline unsigned int lowest_bit(std::uint64_t v)
+	{
+#if defined(__GNUC__)
+		return static_cast<unsigned int>(__builtin_ctzll(v));
+#elif defined(_MSC_VER) && defined(_M_X64)
+		unsigned long ind = 0;
+		_BitScanForward64(&ind, v);
+		return static_cast<unsigned int>(ind);
+#else
+		return popcount((v & (~v + 1)) - 1);
+#endif
+	}
+
+	//------------------------------------------------------------------------------
+
+	// Invariant: 0 <= index of any cell < capacity
+	class Bitboard {	// Set of cells of field, one bit for each cell
+	public:
+		static constexpr unsigned int capacity = 128;	// Max number of cells
+
+		// Construction
+		constexpr Bitboard() : lo{ 0 }, hi{ 0 } { }
+		constexpr Bitboard(std::uint64_t l, std::uint64_t h) : lo{ l }, hi{ h } { }
+		// Constructs bitboard with the only cell indexed with i
+		static Bitboard cell(unsigned int i)
+		{ return i < 64 ? Bitboard{ std::uint64_t{ 1 } << i, 0 } : Bitboard{ 0, std::uint64_t{ 1 } << (i - 64) }; }
+		// Constructs bitboard with first n cells
+		static Bitboard first(unsigned int n)
+		{
+			return n >= capacity ? ~Bitboard{} : n >= 64 ? Bitboard{ ~std::uint64_t{ 0 }, (std::uint64_t{ 1 } << (n - 64)) - 1 }
+				: Bitboard{ (std::uint64_t{ 1 } << n) - 1, 0 };
+		}
+
+		// Access to parameters (writing)
+		void set(unsigned int i) { *this |= cell(i); }
+		void reset(unsigned int i) { *this &= ~cell(i); }
+		void clear() { lo = hi = 0; }
+
+		// Access to parameters (reading)
+		bool test(unsigned int i) const { return i < 64 ? (lo >> i) & 1 : (hi >> (i - 64)) & 1; }
+		bool any() const { return (lo | hi) != 0; }
+		bool none() const { return (lo | hi) == 0; }
+		unsigned int count() const { return popcount(lo) + popcount(hi); }
+		// Index of first cell; capacity if there are no cells
+		unsigned int front() const { return lo ? lowest_bit(lo) : hi ? 64 + lowest_bit(hi) : capacity; }
+		unsigned int nth(unsigned int n) const;
+		std::uint64_t low() const { return lo; }
+		std::uint64_t high() const { return hi; }
+
+		// Set operations
+		Bitboard operator~() const { return Bitboard{ ~lo, ~hi }; }
+		Bitboard& operator&=(const Bitboard& b) { lo &= b.lo; hi &= b.hi; return *this; }
+		Bitboard& operator|=(const Bitboard& b) { lo |= b.lo; hi |= b.hi; return *this; }
+		Bitboard& operator^=(const Bitboard& b) { lo ^= b.lo; hi ^= b.hi; return *this; }
+		Bitboard& operator<<=(unsigned int n);
+		Bitboard& operator>>=(unsigned int n);
+
+	private:
+		std::uint64_t lo;	// Cells [0:64)
+		std::uint64_t hi;	// Cells [64:128)
+	};
+
+	// Determines index of n-th cell (counting from 0); n must be less than count()
+	inline unsigned int Bitboard::nth(unsigned int n) const
+	{
+		const unsigned int lo_num = popcount(lo);
+		unsigned int offset = n < lo_num ? 0 : 64;
+		std::uint64_t v = n < lo_num ? lo : hi;
+		n = n < lo_num ? n : n - lo_num;
+		// Skip whole bytes before byte of n-th cell
+		for (unsigned int num = popcount(v & 0xFF); n >= num; num = popcount(v & 0xFF)) {
+			n -= num;
+			v >>= 8;
+			offset += 8;
+		}
+		for (; n; --n)		// Skip first n cells in byte
+			v &= v - 1;
+		return offset + lowest_bit(v);
+	}
+
+	// Shifts cells n positions towards greater indexes
+	inline Bitboard& Bitboard::operator<<=(unsigned int n)
+	{
+		if (n >= capacity) lo = hi = 0;
+		else if (n >= 64) { hi = lo << (n - 64); lo = 0; }
+		else if (n) { hi = (hi << n) | (lo >> (64 - n)); lo <<= n; }
+		return *this;
+	}
+
+	// Shifts cells n positions towards lesser indexes
+	inline Bitboard& Bitboard::operator>>=(unsigned int n)
+	{
+		if (n >= capacity) lo = hi = 0;
+		else if (n >= 64) { lo = hi >> (n - 64); hi = 0; }
+		else if (n) { lo = (lo >> n) | (hi << (64 - n)); hi >>= n; }
+		return *this;
+	}
+
+	// Helper functions
+	inline Bitboard operator&(Bitboard a, const Bitboard& b) { return a &= b; }
+	inline Bitboard operator|(Bitboard a, const Bitboard& b) { return a |= b; }
+	inline Bitboard operator^(Bitboard a, const Bitboard& b) { return a ^= b; }
+	inline Bitboard operator<<(Bitboard a, unsigned int n) { return a <<= n; }
+	inline Bitboard operator>>(Bitboard a, unsigned int n) { return a >>= n; }
+	inline bool operator==(const Bitboard& a, const Bitboard& b) { return a.low() == b.low() && a.high() == b.high(); }
+	inline bool operator!=(const Bitboard& a, const Bitboard& b) { return !(a == b); }
+
+	//------------------------------------------------------------------------------
+
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,77 @@
+#include "Board.h"
+
+//------------------------------------------------------------------------------
+
+namespace Game_engine {
+
+	//------------------------------------------------------------------------------
+
+	constexpr unsigned char Board::no_ship;
+
+	// Constructs empty board of cols columns and rows rows
+	Board::Board(unsigned int cols, unsigned int rows)
+		: c{ cols }, r{ rows }, occupied{}, hits{}, misses{}, ships{},
+		owners(cols * rows, no_ship), remaining{}, left{ 0 }
+	{
+		if (cols * rows > Bitboard::capacity)	// Handle of too large field
+			throw std::invalid_argument("Bad Board: field has more than 128 cells");
+	}
+
+	// Places ship consisting of cells onto board; returns id of ship
+	unsigned int Board::add_ship(const Bitboard& cells)
+	{
+		if (ships.size() == no_ship)		// Handle of too many ships
+			throw std::length_error("Bad Board: too many ships");
+		const unsigned char id = static_cast<unsigned char>(ships.size());
+		ships.push_back(cells);
+		remaining.push_back((cells & ~hits).count());
+		left += (cells & ~occupied & ~hits).count();
+		occupied |= cells;
+		// Mark cells of ship with its id
+		for (Bitboard rest = cells; rest.any(); rest.reset(rest.front()))
+			owners[rest.front()] = id;
+		return id;
+	}
+
+	// Removes all ships from board
+	void Board::clear_ships()
+	{
+		// Unmark cells of ships
+		for (Bitboard rest = occupied; rest.any(); rest.reset(rest.front()))
+			owners[rest.front()] = no_ship;
+		ships.clear();
+		remaining.clear();
+		occupied.clear();
+		left = 0;
+	}
+
+	// Marks cell indexed with i as shot; returns result of shot (hit, sunk or miss)
+	Shot_result Board::shot(unsigned int i)
+	{
+		const unsigned char id = owners[i];
+		if (id == no_ship) {
+			misses.set(i);
+			return Shot_result::miss;
+		}
+		if (hits.test(i))		// Repeated shot at hitted cell
+			return Shot_result::hit;
+		hits.set(i);
+		--left;
+		return --remaining[id] == 0 ? Shot_result::sunk : Shot_result::hit;
+	}
+
+	// Marks all cells of board as not shot
+	void Board::restore()
+	{
+		hits.clear();
+		misses.clear();
+		for (unsigned int i = 0; i < ships.size(); ++i)
+			remaining[i] = ships[i].count();
+		left = occupied.count();
+	}
+
+	//------------------------------------------------------------------------------
+
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,68 @@
+// Headless game state of field
+
+//------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <stdexcept>
+#include "Bitboard.h"
+
+//------------------------------------------------------------------------------
+
+namespace Game_engine {
+
+	//------------------------------------------------------------------------------
+
+	enum class Shot_result {	// Results of shot at cell
+		miss, hit, sunk			// Sunk is hit of last not hitted cell of ship
+	};
+
+	//------------------------------------------------------------------------------
+
+	// Invariant: cols * rows <= Bitboard::capacity
+	// Note: cell at column c and row r is indexed with c * rows + r
+	class Board {	// Occupancy, hits and misses of field
+	public:
+		static constexpr unsigned char no_ship = 0xFF;	// Owner of cells out of ships
+
+		// Construction
+		Board(unsigned int cols, unsigned int rows);
+
+		// Access to parameters (writing)
+		unsigned int add_ship(const Bitboard& cells);
+		void clear_ships();
+		Shot_result shot(unsigned int i);
+		void restore();
+
+		// Access to parameters (reading)
+		bool is_sunk() const { return left == 0; }
+		bool is_sunk(unsigned int id) const { return remaining[id] == 0; }
+		unsigned int owner(unsigned int i) const { return owners[i]; }
+		unsigned int cells_left(unsigned int id) const { return remaining[id]; }
+		unsigned int cells_left() const { return left; }
+		unsigned int index(unsigned int col, unsigned int row) const { return col * r + row; }
+		unsigned int columns() const { return c; }
+		unsigned int rows() const { return r; }
+		unsigned int size() const { return c * r; }
+		unsigned int number_of_ships() const { return ships.size(); }
+		const Bitboard& ship(unsigned int id) const { return ships[id]; }
+		const Bitboard& occupancy() const { return occupied; }
+		const Bitboard& hit_cells() const { return hits; }
+		const Bitboard& missed_cells() const { return misses; }
+
+	private:
+		unsigned int c, r;				// Number of columns and rows
+		Bitboard occupied;				// Cells of ships
+		Bitboard hits;					// Shot cells of ships
+		Bitboard misses;				// Shot cells out of ships
+		std::vector<Bitboard> ships;	// Cells of each ship
+		std::vector<unsigned char> owners;		// Id of ship for each cell
+		std::vector<unsigned int> remaining;	// Number of not hitted cells of each ship
+		unsigned int left;						// Number of not hitted cells of all ships
+	};
+
+	//------------------------------------------------------------------------------
+
+}
+
+//------------------------------------------------------------------------------
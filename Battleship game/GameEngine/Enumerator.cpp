@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <thread>
+#include "Enumerator.h"
+
+//------------------------------------------------------------------------------
+
+namespace Game_engine {
+
+	//------------------------------------------------------------------------------
+
+	// Applies permutation of cells sym to cells
+	Bitboard transform(const std::vector<unsigned int>& sym, Bitboard cells)
+	{
+		Bitboard res;
+		for (; cells.any(); cells.reset(cells.front()))
+			res.set(sym[cells.front()]);
+		return res;
+	}
+
+	// Determines symmetries of field of cols * rows as permutations of its cells
+	std::vector<std::vector<unsigned int>> field_symmetries(unsigned int cols, unsigned int rows)
+	{
+		std::vector<std::vector<unsigned int>> syms;
+		const unsigned int num = cols == rows ? 8 : 4;		// Square field can be also transposed
+		for (unsigned int s = 0; s < num; ++s) {
+			std::vector<unsigned int> sym(cols * rows);
+			for (unsigned int col = 0; col < cols; ++col)
+				for (unsigned int row = 0; row < rows; ++row) {
+					const unsigned int c = s & 1 ? cols - 1 - col : col;	// Mirror columns
+					const unsigned int r = s & 2 ? rows - 1 - row : row;	// Mirror rows
+					sym[col * rows + row] = s & 4 ? r * rows + c : c * rows + r;
+				}
+			syms.push_back(sym);
+		}
+		return syms;
+	}
+
+	//------------------------------------------------------------------------------
+
+	// Constructs enumerator of layouts of ships of lengths ls on field of p
+	Layout_enumerator::Layout_enumerator(const Placement& p, const std::vector<unsigned int>& ls)
+		: plc{ p }, lens{ ls }, syms{}, reps{}, orbit_syms{}, tasks{}, not_first{}, not_last{}, next{ 0 }, done{ 0 }
+	{
+		if (lens.empty())		// Handle of empty fleet
+			throw std::invalid_argument("Bad Layout_enumerator: no ships");
+		// Ships of same length go one after another; the longest ship of unique length goes first
+		std::sort(lens.begin(), lens.end(), [](unsigned int a, unsigned int b) { return a > b; });
+		auto unique = lens.begin();
+		while (unique != lens.end() && std::count(lens.begin(), lens.end(), *unique) > 1)
+			unique += std::count(lens.begin(), lens.end(), *unique);
+		if (unique != lens.end()) {
+			std::rotate(lens.begin(), unique, std::next(unique));
+			syms = field_symmetries(plc.columns(), plc.rows());
+		}
+		else syms.push_back(field_symmetries(plc.columns(), plc.rows()).front());	// Identity only
+		for (unsigned int i = 0; i < plc.columns() * plc.rows(); ++i) {
+			if (i % plc.rows() != 0) not_first.set(i);
+			if (i % plc.rows() != plc.rows() - 1) not_last.set(i);
+		}
+		// Split positions of first ship into orbits
+		const std::vector<Position> first = positions(0, Bitboard{}, 0);
+		std::vector<bool> seen(first.size(), false);
+		for (unsigned int i = 0; i < first.size(); ++i) {
+			if (seen[i])
+				continue;
+			reps.push_back(first[i]);
+			orbit_syms.push_back({});
+			for (unsigned int s = 0; s < syms.size(); ++s) {
+				const Bitboard image = transform(syms[s], first[i].cells);
+				for (unsigned int j = i; j < first.size(); ++j)
+					if (!seen[j] && first[j].cells == image) {
+						seen[j] = true;
+						orbit_syms.back().push_back(s);
+					}
+			}
+		}
+		// Split layouts of each orbit by position of second ship
+		for (unsigned int k = 0; k < reps.size(); ++k) {
+			if (lens.size() == 1) {
+				tasks.push_back(Task{ k, Position{ 0, Bitboard{}, Bitboard{} } });
+				continue;
+			}
+			const unsigned int min_order = lens[1] == lens[0] ? reps[k].order + 1 : 0;
+			for (const Position& pos : positions(1, reps[k].area, min_order))
+				tasks.push_back(Task{ k, pos });
+		}
+	}
+
+	// Determines positions of ship i outside of forbidden cells, with order at least min_order
+	std::vector<Layout_enumerator::Position> Layout_enumerator::positions(unsigned int i,
+		const Bitboard& forbidden, unsigned int min_order) const
+	{
+		std::vector<Position> res;
+		for (unsigned int o = 0; o < (lens[i] > 1 ? 2u : 1u); ++o) {
+			const Orientation orient = static_cast<Orientation>(o);
+			for (Bitboard rest = plc.legal(lens[i], orient, forbidden); rest.any(); rest.reset(rest.front())) {
+				const unsigned int order = o * Bitboard::capacity + rest.front();
+				if (order >= min_order)
+					res.push_back(Position{ order, plc.cells(lens[i], orient, rest.front()), plc.area(lens[i], orient, rest.front()) });
+			}
+		}
+		return res;
+	}
+
+	// Counts layouts of ships from i on outside of forbidden cells, with order of ship i at least min_order;
+	// adds number of these layouts occupying each cell to cells
+	unsigned long long Layout_enumerator::count(unsigned int i, unsigned int min_order, const Bitboard& forbidden,
+		std::vector<unsigned long long>& cells) const
+	{
+		if (i == lens.size())		// Complete layout
+			return 1;
+		if (lens[i] == 1 && lens.size() - i <= max_boats)		// Last torpedo boats (lengths after first go in descending order)
+			return count_boats(lens.size() - i, plc.field() & ~forbidden & ~Bitboard::first(min_order), cells);
+		const bool same = i + 1 < lens.size() && lens[i + 1] == lens[i];	// Next ship is interchangeable
+		unsigned long long total = 0;
+		for (unsigned int o = 0; o < (lens[i] > 1 ? 2u : 1u); ++o) {
+			const Orientation orient = static_cast<Orientation>(o);
+			Bitboard rest = plc.legal(lens[i], orient, forbidden);
+			if (min_order > o * Bitboard::capacity)		// Skip positions of lesser order
+				rest &= ~Bitboard::first(min_order - o * Bitboard::capacity);
+			for (; rest.any(); rest.reset(rest.front())) {
+				const unsigned int anchor = rest.front();
+				const unsigned long long num = count(i + 1, same ? o * Bitboard::capacity + anchor + 1 : 0,
+					forbidden | plc.area(lens[i], orient, anchor), cells);
+				if (num)
+					for (Bitboard ship = plc.cells(lens[i], orient, anchor); ship.any(); ship.reset(ship.front()))
+						cells[ship.front()] += num;
+				total += num;
+			}
+		}
+		return total;
+	}
+
+	// Counts layouts of k torpedo boats in free cells; adds number of these layouts occupying each cell to cells
+	unsigned long long Layout_enumerator::count_boats(unsigned int k, const Bitboard& free,
+		std::vector<unsigned long long>& cells) const
+	{
+		unsigned long long total = 0;		// Each layout is counted once for each of its k cells
+		for (Bitboard rest = free; rest.any(); rest.reset(rest.front())) {
+			const unsigned int c = rest.front();
+			const unsigned long long num = independent(k - 1, free & ~plc.area(1, Orientation::horizontal, c));
+			cells[c] += num;
+			total += num;
+		}
+		return total / k;
+	}
+
+	// Counts sets of k (at most 3) free cells not touching each other
+	unsigned long long Layout_enumerator::independent(unsigned int k, const Bitboard& free) const
+	{
+		const long long n = free.count();
+		if (k == 0) return 1;
+		if (k == 1) return n;
+		// Touching pairs of cells by direction from first cell of pair
+		const Bitboard pairs[4] = {
+			free & (free >> 1) & not_last,							// Down
+			free & (free >> plc.rows()),							// Right
+			free & (free >> (plc.rows() + 1)) & not_last,			// Down right
+			free & (free >> (plc.rows() - 1)) & not_first			// Up right
+		};
+		const long long m = pairs[0].count() + pairs[1].count() + pairs[2].count() + pairs[3].count();
+		if (k == 2) return n * (n - 1) / 2 - m;
+		// Degree of each cell as bit-sliced number
+		const Bitboard ends[8] = { pairs[0], pairs[1], pairs[2], pairs[3], pairs[0] << 1, pairs[1] << plc.rows(),
+			pairs[2] << (plc.rows() + 1), pairs[3] << (plc.rows() - 1) };
+		Bitboard deg[4];
+		for (Bitboard carry : ends)
+			for (Bitboard& plane : deg) {
+				const Bitboard next = plane & carry;
+				plane ^= carry;
+				carry = next;
+			}
+		long long squares = 0;		// Sum of squared degrees
+		for (unsigned int p = 0; p < 4; ++p)
+			for (unsigned int q = 0; q < 4; ++q)
+				squares += static_cast<long long>((deg[p] & deg[q]).count()) << (p + q);
+		const long long paths = (squares - 2 * m) / 2;		// Pairs of touching pairs with common cell
+		// Triangles of touching cells lie in squares 2x2: 4 in full square and 1 in square with 3 free cells
+		const Bitboard a = free, b = free >> 1, c = free >> plc.rows(), d = free >> (plc.rows() + 1);
+		const Bitboard full = a & b & c & d & not_last;
+		const Bitboard three = ((a & b & (c | d)) | (c & d & (a | b))) & not_last & ~full;
+		const long long triangles = 4 * full.count() + three.count();
+		// Inclusion-exclusion over touching pairs
+		return n * (n - 1) * (n - 2) / 6 - m * (n - 2) + paths - triangles;
+	}
+
+	// Runs tasks until none is left; accumulates layouts of each orbit in res
+	void Layout_enumerator::work(std::vector<Layout_count>& res)
+	{
+		res.assign(reps.size(), Layout_count{ 0, std::vector<unsigned long long>(plc.columns() * plc.rows(), 0) });
+		for (std::size_t t = next++; t < tasks.size(); t = next++) {
+			const Task& task = tasks[t];
+			std::vector<unsigned long long>& cells = res[task.orbit].cells;
+			const unsigned long long num = lens.size() == 1 ? 1 : count(2, lens.size() > 2 && lens[2] == lens[1] ?
+				task.second.order + 1 : 0, reps[task.orbit].area | task.second.area, cells);
+			for (Bitboard ship = reps[task.orbit].cells | task.second.cells; ship.any(); ship.reset(ship.front()))
+				cells[ship.front()] += num;
+			res[task.orbit].layouts += num;
+			++done;
+		}
+	}
+
+	// Counts all legal layouts and layouts occupying each cell using threads (all cores if 0)
+	Layout_count Layout_enumerator::run(unsigned int threads)
+	{
+		if (threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		next = 0;
+		done = 0;
+		// Run tasks in parallel
+		std::vector<std::vector<Layout_count>> part(threads);		// Results of each thread
+		std::vector<std::thread> pool;
+		for (unsigned int t = 1; t < threads; ++t)
+			pool.emplace_back(&Layout_enumerator::work, this, std::ref(part[t]));
+		work(part[0]);
+		for (std::thread& t : pool)
+			t.join();
+		// Restore layouts of whole orbits from layouts of their representatives
+		Layout_count res{ 0, std::vector<unsigned long long>(plc.columns() * plc.rows(), 0) };
+		for (unsigned int k = 0; k < reps.size(); ++k)
+			for (unsigned int s : orbit_syms[k])
+				for (const std::vector<Layout_count>& p : part) {
+					res.layouts += p[k].layouts;
+					for (unsigned int c = 0; c < res.cells.size(); ++c)
+						res.cells[syms[s][c]] += p[k].cells[c];
+				}
+		return res;
+	}
+
+	//------------------------------------------------------------------------------
+
+}
+
+//------------------------------------------------------------------------------
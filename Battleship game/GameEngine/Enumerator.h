@@ -0,0 +1,73 @@
+// Exhaustive enumerator of fleet layouts
+
+//------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <atomic>
+#include "Placement.h"
+
+//------------------------------------------------------------------------------
+
+namespace Game_engine {
+
+	//------------------------------------------------------------------------------
+
+	struct Layout_count {		// Exact numbers of legal layouts
+		unsigned long long layouts;				// All layouts
+		std::vector<unsigned long long> cells;	// Layouts occupying each cell
+	};
+
+	//------------------------------------------------------------------------------
+
+	// Note: ships of same length are interchangeable; if length of some ship is unique, only layouts with that ship
+	// at one position of each of its orbits under symmetries of field are enumerated, and others are restored from them
+	class Layout_enumerator {
+	public:
+		static constexpr unsigned int max_boats = 4;	// Max number of last torpedo boats counted without enumeration
+
+		// Construction
+		Layout_enumerator(const Placement& p, const std::vector<unsigned int>& ls);
+
+		// Enumeration of layouts using threads (all cores if 0)
+		Layout_count run(unsigned int threads = 0);
+
+		// Access to parameters (reading)
+		unsigned int symmetries() const { return syms.size(); }
+		std::size_t number_of_tasks() const { return tasks.size(); }
+		std::size_t tasks_done() const { return done; }		// Can be read while running
+
+	private:
+		struct Position {			// Position of ship
+			unsigned int order;		// Order of position (orientation, anchor)
+			Bitboard cells;
+			Bitboard area;
+		};
+		struct Task {				// Layouts with first two ships at fixed positions
+			unsigned int orbit;		// Orbit of first ship
+			Position second;
+		};
+
+		const Placement& plc;
+		std::vector<unsigned int> lens;				// Lengths of ships (ship with unique length first)
+		std::vector<std::vector<unsigned int>> syms;	// Symmetries of field as permutations of cells
+		std::vector<Position> reps;					// Representative positions of first ship in each orbit
+		std::vector<std::vector<unsigned int>> orbit_syms;	// Symmetries mapping representative to each of its orbit
+		std::vector<Task> tasks;
+		Bitboard not_first, not_last;				// Cells outside of first and last rows
+		std::atomic<std::size_t> next, done;		// Next task to run and number of completed tasks
+
+		// Helper functions
+		std::vector<Position> positions(unsigned int i, const Bitboard& forbidden, unsigned int min_order) const;
+		unsigned long long count(unsigned int i, unsigned int min_order, const Bitboard& forbidden,
+			std::vector<unsigned long long>& cells) const;
+		unsigned long long count_boats(unsigned int k, const Bitboard& free, std::vector<unsigned long long>& cells) const;
+		unsigned long long independent(unsigned int k, const Bitboard& free) const;
+		void work(std::vector<Layout_count>& res);
+	};
+
+	//------------------------------------------------------------------------------
+
+}
+
+//------------------------------------------------------------------------------
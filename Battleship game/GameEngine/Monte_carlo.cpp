@@ -0,0 +1,206 @@
+#include <algorithm>
+#include "Monte_carlo.h"
+
+//------------------------------------------------------------------------------
+
+namespace Game_engine {
+
+	//------------------------------------------------------------------------------
+
+	// Constructs targeting of field of cols * rows, which spends b on each move using threads (all cores if 0),
+	// but samples no more than max layouts; engines of threads are seeded from r
+	Monte_carlo_targeting::Monte_carlo_targeting(unsigned int cols, unsigned int rows, Placement::Engine& r,
+		Clock::duration b, unsigned int threads, unsigned long long max)
+		: plc{ cols, rows }, ran{ r }, inside{}, left{}, shot{}, hits{}, blocked{}, series{}, workers{}, pool{},
+		generation{ 0 }, running{ 0 }, quit{ false }, deadline{}, budget{ b }, max_samples{ max }, total{ 0 }, samples{ 0 }
+	{
+		if (threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		workers.resize(threads);
+		for (Worker& w : workers) {
+			w.ran.seed(ran());		// Own stream of random numbers
+			w.counts.assign(cols * rows, 0);
+		}
+		for (Worker& w : workers)
+			pool.emplace_back(&Monte_carlo_targeting::work, this, std::ref(w));
+	}
+
+	// Stops threads of pool
+	Monte_carlo_targeting::~Monte_carlo_targeting()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ mtx };
+			quit = true;
+		}
+		start_cv.notify_all();
+		for (std::thread& t : pool)
+			t.join();
+	}
+
+	// Starts new game against fleet of ships of lengths lens
+	void Monte_carlo_targeting::reset(const std::vector<unsigned int>& lens)
+	{
+		left = lens;
+		std::sort(left.begin(), left.end(), [](unsigned int a, unsigned int b) { return a > b; });
+		shot.clear();
+		hits.clear();
+		blocked.clear();
+		inside.clear();
+		for (unsigned int len = 0; len <= (left.empty() ? 0 : left.front()); ++len)
+			for (unsigned int o = 0; o < 2; ++o)
+				inside.push_back(len ? plc.legal(len, static_cast<Orientation>(o), Bitboard{}) : Bitboard{});
+	}
+
+	// Samples layouts until deadline and chooses unknown cell occupied in most of them
+	unsigned int Monte_carlo_targeting::choose()
+	{
+		series.clear();
+		for (Bitboard rest = hits; rest.any(); rest &= ~series.back())
+			series.push_back(connected(plc, hits, rest.front()));
+		// Run threads of pool and wait for them
+		{
+			std::lock_guard<std::mutex> lock{ mtx };
+			deadline = Clock::now() + budget;
+			total = 0;
+			running = workers.size();
+			++generation;
+		}
+		start_cv.notify_all();
+		{
+			std::unique_lock<std::mutex> lock{ mtx };
+			done_cv.wait(lock, [this] { return running == 0; });
+		}
+		samples = total;
+		// Find most occupied unknown cell, choosing randomly among equal ones
+		unsigned int res = Bitboard::capacity;
+		unsigned long long most = 0;
+		unsigned int ties = 0;
+		for (Bitboard rest = plc.field() & ~shot; rest.any(); rest.reset(rest.front())) {
+			unsigned long long num = 0;
+			for (const Worker& w : workers)
+				num += w.counts[rest.front()];
+			if (num == 0 || num < most)
+				continue;
+			if (num > most) {
+				most = num;
+				ties = 0;
+			}
+			if (std::uniform_int_distribution<unsigned int>{ 0, ties++ }(ran) == 0)
+				res = rest.front();
+		}
+		if (res != Bitboard::capacity)
+			return res;
+		return random_cell(plc.field() & ~shot, ran);		// None of layouts is sampled
+	}
+
+	// Learns result res of shot at cell i
+	void Monte_carlo_targeting::report(unsigned int i, Shot_result res)
+	{
+		if (shot.test(i) && !hits.test(i))		// Cell is known already
+			return;
+		shot.set(i);
+		if (res == Shot_result::miss) {
+			blocked.set(i);
+			return;
+		}
+		hits.set(i);
+		// Cells touching hitted one by angles are empty
+		shot |= corners(plc, i);
+		blocked |= corners(plc, i);
+		if (res == Shot_result::sunk) {
+			// Sunken ship consists of hitted cells connected with i (ships don't touch each other)
+			const Bitboard ship = connected(plc, hits, i);
+			hits &= ~ship;
+			shot |= plc.halo(ship);
+			blocked |= plc.halo(ship);
+			const auto p = std::find(left.begin(), left.end(), ship.count());
+			if (p != left.end())
+				left.erase(p);
+		}
+	}
+
+	// Samples layouts for each started move until deadline or limit of samples
+	void Monte_carlo_targeting::work(Worker& w)
+	{
+		unsigned long long seen = 0;		// Last sampled move
+		for (;;) {
+			{
+				std::unique_lock<std::mutex> lock{ mtx };
+				start_cv.wait(lock, [&] { return quit || generation != seen; });
+				if (quit)
+					return;
+				seen = generation;
+			}
+			std::fill(w.counts.begin(), w.counts.end(), 0);
+			while (total < max_samples && Clock::now() < deadline)
+				if (sample(w))
+					++total;
+			{
+				std::lock_guard<std::mutex> lock{ mtx };
+				--running;
+			}
+			done_cv.notify_one();
+		}
+	}
+
+	// Samples layout consistent with known cells and counts its unknown cells in w; false if sampling failed
+	bool Monte_carlo_targeting::sample(Worker& w) const
+	{
+		w.lens = left;
+		Bitboard forbidden = blocked, layout;
+		// Place ship covering each series of hits
+		for (const Bitboard& s : series) {
+			w.cands.clear();
+			w.kinds.clear();
+			for (unsigned int k = 0; k < w.lens.size(); ++k) {
+				const unsigned int len = w.lens[k];
+				if (len < s.count())
+					continue;
+				for (unsigned int o = 0; o < (len > 1 ? 2u : 1u); ++o) {
+					const Orientation orient = static_cast<Orientation>(o);
+					const unsigned int step = orient == Orientation::horizontal ? plc.rows() : 1;
+					// Anchors of positions covering first cell of series
+					for (unsigned int j = 0; j < len && j * step <= s.front(); ++j) {
+						const unsigned int anchor = s.front() - j * step;
+						if (!inside[len * 2 + o].test(anchor))
+							continue;
+						const Bitboard cells = plc.cells(len, orient, anchor);
+						if ((cells & s) == s && (cells & forbidden).none() &&
+							(plc.area(len, orient, anchor) & hits & ~cells).none()) {
+							w.cands.push_back(Ship_position{ anchor, orient });
+							w.kinds.push_back(k);
+						}
+					}
+				}
+			}
+			if (w.cands.empty())
+				return false;
+			const unsigned int c = std::uniform_int_distribution<unsigned int>{ 0, static_cast<unsigned int>(w.cands.size()) - 1 }(w.ran);
+			const unsigned int len = w.lens[w.kinds[c]];
+			layout |= plc.cells(len, w.cands[c].orient, w.cands[c].anchor);
+			forbidden |= plc.area(len, w.cands[c].orient, w.cands[c].anchor);
+			w.lens.erase(w.lens.begin() + w.kinds[c]);
+		}
+		// Place other ships one by one
+		for (unsigned int len : w.lens) {
+			const Bitboard hor = plc.legal(len, Orientation::horizontal, forbidden);
+			const Bitboard ver = len > 1 ? plc.legal(len, Orientation::vertical, forbidden) : Bitboard{};
+			const unsigned int num = hor.count() + ver.count();
+			if (num == 0)
+				return false;
+			const unsigned int n = std::uniform_int_distribution<unsigned int>{ 0, num - 1 }(w.ran);
+			const Orientation orient = n < hor.count() ? Orientation::horizontal : Orientation::vertical;
+			const unsigned int anchor = n < hor.count() ? hor.nth(n) : ver.nth(n - hor.count());
+			layout |= plc.cells(len, orient, anchor);
+			forbidden |= plc.area(len, orient, anchor);
+		}
+		for (Bitboard rest = layout & ~shot; rest.any(); rest.reset(rest.front()))
+			++w.counts[rest.front()];
+		return true;
+	}
+
+	//------------------------------------------------------------------------------
+
+}
+
+//------------------------------------------------------------------------------
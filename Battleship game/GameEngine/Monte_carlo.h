@@ -0,0 +1,89 @@
+// Choice of cells to shoot at by sampling of layouts
+
+//------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include "Targeting.h"
+
+//------------------------------------------------------------------------------
+
+namespace Game_engine {
+
+	//------------------------------------------------------------------------------
+
+	// Note: layouts consistent with known cells are sampled by threads of pool, each with its own random engine,
+	// until deadline of move or limit of samples; ship covering each series of hitted cells is placed first,
+	// and other ships are placed one by one uniformly among their legal positions, so sampling isn't exactly uniform
+	class Monte_carlo_targeting : public Targeting {	// Shooting at cells occupied in most of sampled layouts
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		// Construction
+		Monte_carlo_targeting(unsigned int cols, unsigned int rows, Placement::Engine& r,
+			Clock::duration b = std::chrono::milliseconds(5), unsigned int threads = 0,
+			unsigned long long max = 1000000);
+		Monte_carlo_targeting(const Monte_carlo_targeting&) = delete;
+		Monte_carlo_targeting& operator=(const Monte_carlo_targeting&) = delete;
+		~Monte_carlo_targeting();
+
+		// Access to parameters (writing)
+		void reset(const std::vector<unsigned int>& lens) override;
+		unsigned int choose() override;
+		void report(unsigned int i, Shot_result res) override;
+		void set_budget(Clock::duration b) { budget = b; }
+		void set_max_samples(unsigned long long max) { max_samples = max; }
+
+		// Access to parameters (reading)
+		Clock::duration time_budget() const { return budget; }
+		unsigned long long max_number_of_samples() const { return max_samples; }
+		unsigned long long number_of_samples() const { return samples; }	// Sampled at last move
+		unsigned int number_of_threads() const { return workers.size(); }
+
+	private:
+		struct Worker {				// State of thread of pool
+			Placement::Engine ran;
+			std::vector<unsigned long long> counts;	// Number of sampled layouts occupying each cell
+			std::vector<unsigned int> lens;			// Lengths of ships left to place
+			std::vector<Ship_position> cands;		// Positions to choose from
+			std::vector<unsigned int> kinds;		// Indexes of lengths of cands
+		};
+
+		Placement plc;
+		Placement::Engine& ran;
+		std::vector<Bitboard> inside;		// Anchors of ships inside field for each length and orientation
+		// Known cells
+		std::vector<unsigned int> left;		// Lengths of ships not sunk yet (largest first)
+		Bitboard shot;						// Cells shooted at or known to be empty
+		Bitboard hits;						// Hitted cells of not sunken ships
+		Bitboard blocked;					// Cells where ships can't be
+		std::vector<Bitboard> series;		// Connected series of hits
+		// Pool of threads
+		std::vector<Worker> workers;
+		std::vector<std::thread> pool;
+		std::mutex mtx;
+		std::condition_variable start_cv, done_cv;
+		unsigned long long generation;		// Number of started moves
+		unsigned int running;				// Number of threads sampling current move
+		bool quit;
+		Clock::time_point deadline;
+		Clock::duration budget;				// Time budget of move
+		unsigned long long max_samples;		// Limit of samples of move
+		std::atomic<unsigned long long> total;	// Number of samples of current move so far
+		unsigned long long samples;
+
+		// Helper functions
+		void work(Worker& w);
+		bool sample(Worker& w) const;
+	};
+
+	//------------------------------------------------------------------------------
+
+}
+
+//------------------------------------------------------------------------------
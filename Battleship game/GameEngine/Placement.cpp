@@ -0,0 +1,111 @@
+#include <algorithm>
+#include "Placement.h"
+
+//------------------------------------------------------------------------------
+
+namespace Game_engine {
+
+	//------------------------------------------------------------------------------
+
+	// Constructs placement for field of cols columns and rows rows
+	Placement::Placement(unsigned int cols, unsigned int rows)
+		: c{ cols }, r{ rows }, all{ Bitboard::first(cols * rows) }, top{}, bottom{}, inside{}, areas{}
+	{
+		if (cols * rows > Bitboard::capacity)	// Handle of too large field
+			throw std::invalid_argument("Bad Placement: field has more than 128 cells");
+		for (unsigned int col = 0; col < c; ++col) {
+			top.set(col * r);
+			bottom.set(col * r + r - 1);
+		}
+		// Anchors of ships of each length (both orientations) which lie inside field
+		const unsigned int max_len = std::max(c, r);
+		inside.resize((max_len + 1) * 2);
+		for (unsigned int len = 1; len <= max_len; ++len)
+			for (unsigned int col = 0; col < c; ++col)
+				for (unsigned int row = 0; row < r; ++row) {
+					if (col + len <= c)
+						inside[len * 2].set(col * r + row);
+					if (row + len <= r)
+						inside[len * 2 + 1].set(col * r + row);
+				}
+		// Around areas of ships at each of their anchors inside field
+		areas.resize((max_len + 1) * 2 * c * r);
+		for (unsigned int len = 1; len <= max_len; ++len)
+			for (unsigned int o = 0; o < 2; ++o)
+				for (Bitboard rest = inside[len * 2 + o]; rest.any(); rest.reset(rest.front()))
+					areas[(len * 2 + o) * c * r + rest.front()] =
+						halo(cells(len, static_cast<Orientation>(o), rest.front()));
+	}
+
+	// Determines anchors of ships of length len oriented with o, which
+	// lie inside field and don't cover any of forbidden cells
+	Bitboard Placement::legal(unsigned int len, Orientation o, const Bitboard& forbidden) const
+	{
+		if (len == 0 || len * 2 + 1 >= inside.size())	// Handle of ships longer than field
+			return Bitboard{};
+		// Anchor is blocked if any cell at offset j * step from it is forbidden
+		Bitboard blocked = forbidden;
+		for (unsigned int j = 1; j < len; ++j)
+			blocked |= forbidden >> (j * step(o));
+		return inside[len * 2 + static_cast<unsigned int>(o)] & ~blocked;
+	}
+
+	// Determines cells of ship of length len oriented with o, with top-left cell at anchor
+	Bitboard Placement::cells(unsigned int len, Orientation o, unsigned int anchor) const
+	{
+		Bitboard res;
+		for (unsigned int j = 0; j < len; ++j)
+			res.set(anchor + j * step(o));
+		return res;
+	}
+
+	// Determines cells and their around area (by sides and angles)
+	Bitboard Placement::halo(const Bitboard& cells) const
+	{
+		// Neighbours in the same column, without passing to the next one
+		const Bitboard v = cells | ((cells & ~bottom) << 1) | ((cells & ~top) >> 1);
+		return (v | (v << r) | (v >> r)) & all;
+	}
+
+	// Locates ships of lengths lens randomly in such way that none of them touch each other;
+	// each ship is placed uniformly among its positions, which are legal for previous ships;
+	// returns false if there is no room for ships; adds number of positions abandoned
+	// by backtracking (retries) to retries if passed
+	bool Placement::random_layout(const std::vector<unsigned int>& lens, std::vector<Ship_position>& res, Engine& ran,
+		unsigned long long* retries) const
+	{
+		res.resize(lens.size());
+		return place(lens, 0, Bitboard{}, res, ran, retries);
+	}
+
+	// Places ship indexed with i and all following ones outside of forbidden
+	// cells; backtracks to other positions if following ships have no room
+	bool Placement::place(const std::vector<unsigned int>& lens, unsigned int i, const Bitboard& forbidden,
+		std::vector<Ship_position>& res, Engine& ran, unsigned long long* retries) const
+	{
+		if (i == lens.size())		// All ships are placed
+			return true;
+		Bitboard hor = legal(lens[i], Orientation::horizontal, forbidden);
+		Bitboard ver = lens[i] > 1 ? legal(lens[i], Orientation::vertical, forbidden) : Bitboard{};
+		while (hor.any() || ver.any()) {
+			// Choose any of remaining positions
+			const unsigned int hor_num = hor.count();
+			const unsigned int k = std::uniform_int_distribution<unsigned int>{ 0, hor_num + ver.count() - 1 }(ran);
+			const Orientation o = k < hor_num ? Orientation::horizontal : Orientation::vertical;
+			Bitboard& from = k < hor_num ? hor : ver;
+			const unsigned int anchor = from.nth(k < hor_num ? k : k - hor_num);
+			from.reset(anchor);			// Don't try position again
+			res[i] = Ship_position{ anchor, o };
+			if (place(lens, i + 1, forbidden | area(lens[i], o, anchor), res, ran, retries))
+				return true;
+			if (retries)
+				++*retries;
+		}
+		return false;
+	}
+
+	//------------------------------------------------------------------------------
+
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,67 @@
+// Placement of ships on field
+
+//------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <random>
+#include <stdexcept>
+#include "Bitboard.h"
+
+//------------------------------------------------------------------------------
+
+namespace Game_engine {
+
+	//------------------------------------------------------------------------------
+
+	enum class Orientation {
+		horizontal, vertical
+	};
+
+	struct Ship_position {		// Location of ship on field
+		unsigned int anchor;	// Index of top-left cell
+		Orientation orient;
+	};
+
+	//------------------------------------------------------------------------------
+
+	// Invariant: cols * rows <= Bitboard::capacity
+	// Note: cell at column c and row r is indexed with c * rows + r, as in Board
+	class Placement {	// Legal positions of ships, which don't touch each other
+	public:
+		using Engine = std::default_random_engine;
+
+		// Construction
+		Placement(unsigned int cols, unsigned int rows);
+
+		// Access to parameters (reading)
+		Bitboard legal(unsigned int len, Orientation o, const Bitboard& forbidden) const;
+		Bitboard cells(unsigned int len, Orientation o, unsigned int anchor) const;
+		Bitboard halo(const Bitboard& cells) const;
+		// Cells of ship at anchor and its around area (by sides and angles)
+		const Bitboard& area(unsigned int len, Orientation o, unsigned int anchor) const
+		{ return areas[(len * 2 + static_cast<unsigned int>(o)) * c * r + anchor]; }
+		bool random_layout(const std::vector<unsigned int>& lens, std::vector<Ship_position>& res, Engine& ran,
+			unsigned long long* retries = nullptr) const;
+		unsigned int columns() const { return c; }
+		unsigned int rows() const { return r; }
+		const Bitboard& field() const { return all; }
+
+	private:
+		unsigned int c, r;				// Number of columns and rows
+		Bitboard all;					// All cells of field
+		Bitboard top, bottom;			// Cells of first and last rows
+		std::vector<Bitboard> inside;	// Anchors of ships inside field for each length and orientation
+		std::vector<Bitboard> areas;	// Around areas of ships for each length, orientation and anchor
+
+		// Helper functions
+		unsigned int step(Orientation o) const { return o == Orientation::horizontal ? r : 1; }
+		bool place(const std::vector<unsigned int>& lens, unsigned int i, const Bitboard& forbidden,
+			std::vector<Ship_position>& res, Engine& ran, unsigned long long* retries) const;
+	};
+
+	//------------------------------------------------------------------------------
+
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,99 @@
+#include <algorithm>
+#include "Sampler.h"
+
+//------------------------------------------------------------------------------
+
+namespace Game_engine {
+
+	//------------------------------------------------------------------------------
+
+	// Constructs sampler of layouts of ships of lengths ls on field of p; bounds of ships
+	// are found by trying all legal positions of first depth ships (deeper is tighter but slower)
+	Layout_sampler::Layout_sampler(const Placement& p, const std::vector<unsigned int>& ls, unsigned int depth)
+		: plc{ p }, lens{ ls }, bounds(ls.size(), 0), feasible{ false }
+	{
+		depth = std::min(depth, static_cast<unsigned int>(lens.size()));
+		// Bounds of ship i are max numbers of positions after all placements of min(i, depth) previous ships
+		for (unsigned int d = 0; d <= depth; ++d) {
+			const std::vector<unsigned int> prev = bounds;
+			std::fill(bounds.begin() + d, bounds.end(), 0);
+			max_positions(0, d, Bitboard{});
+			for (unsigned int i = d; i < lens.size(); ++i)
+				if (d && prev[i] < bounds[i])		// Keep tighter bound of lesser depth
+					bounds[i] = prev[i];
+		}
+		// Each placed ship takes its own cells from cells available to torpedo boats
+		for (unsigned int i = depth + 1; i < lens.size(); ++i)
+			if (lens[i] == 1) {
+				unsigned int taken = 0;		// Cells of ships placed after depth ships
+				for (unsigned int j = depth; j < i; ++j)
+					taken += lens[j];
+				bounds[i] = bounds[i] > taken ? bounds[i] - taken : 0;
+			}
+		// Bounds may be positive even if ships don't fit together, so look for any layout once;
+		// otherwise rejection of all tries would never stop
+		feasible = std::find(bounds.cbegin(), bounds.cend(), 0u) == bounds.cend();
+		if (feasible) {
+			Engine probe;
+			std::vector<Ship_position> layout;
+			feasible = plc.random_layout(lens, layout, probe);
+		}
+	}
+
+	// Determines number of legal positions of ship of length len outside of forbidden cells
+	unsigned int Layout_sampler::positions(unsigned int len, const Bitboard& forbidden) const
+	{
+		return plc.legal(len, Orientation::horizontal, forbidden).count() +
+			(len > 1 ? plc.legal(len, Orientation::vertical, forbidden).count() : 0);
+	}
+
+	// Updates bounds of ships starting from depth with their numbers of
+	// positions after all legal placements of ships from i to depth
+	void Layout_sampler::max_positions(unsigned int i, unsigned int depth, const Bitboard& forbidden)
+	{
+		if (i == depth) {
+			for (unsigned int j = depth; j < lens.size(); ++j)
+				bounds[j] = std::max(bounds[j], positions(lens[j], forbidden));
+			return;
+		}
+		for (unsigned int o = 0; o < (lens[i] > 1 ? 2u : 1u); ++o) {
+			const Orientation orient = static_cast<Orientation>(o);
+			for (Bitboard rest = plc.legal(lens[i], orient, forbidden); rest.any(); rest.reset(rest.front()))
+				max_positions(i + 1, depth, forbidden | plc.area(lens[i], orient, rest.front()));
+		}
+	}
+
+	// Locates ships uniformly among all legal layouts; returns false if there are no legal layouts;
+	// counts rejected and accepted tries in attempts
+	bool Layout_sampler::sample(std::vector<Ship_position>& res, Engine& ran, unsigned long long* attempts) const
+	{
+		if (!feasible)		// Handle of no room for ships
+			return false;
+		res.resize(lens.size());
+		for (bool accepted = false; !accepted; ) {
+			if (attempts) ++*attempts;
+			Bitboard forbidden;
+			accepted = true;
+			for (unsigned int i = 0; i < lens.size() && accepted; ++i) {
+				const Bitboard hor = plc.legal(lens[i], Orientation::horizontal, forbidden);
+				const Bitboard ver = lens[i] > 1 ? plc.legal(lens[i], Orientation::vertical, forbidden) : Bitboard{};
+				const unsigned int hor_num = hor.count();
+				// Draw in [0:bounds[i]), so position k is chosen with probability 1 / bounds[i]
+				const unsigned int k = std::uniform_int_distribution<unsigned int>{ 0, bounds[i] - 1 }(ran);
+				if (k >= hor_num + ver.count()) {	// Reject whole layout
+					accepted = false;
+					break;
+				}
+				const Orientation o = k < hor_num ? Orientation::horizontal : Orientation::vertical;
+				res[i] = Ship_position{ k < hor_num ? hor.nth(k) : ver.nth(k - hor_num), o };
+				forbidden |= plc.area(lens[i], o, res[i].anchor);
+			}
+		}
+		return true;
+	}
+
+	//------------------------------------------------------------------------------
+
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,46 @@
+// Exactly uniform sampler of fleet layouts
+
+//------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include "Placement.h"
+
+//------------------------------------------------------------------------------
+
+namespace Game_engine {
+
+	//------------------------------------------------------------------------------
+
+	// Invariant: bounds[i] >= number of legal positions of ship i after any legal placement of previous ships
+	// Note: ships are placed one by one, and ship i is accepted with probability n / bounds[i], where n is
+	// number of its legal positions; then each ordered layout is sampled with probability 1 / product of bounds,
+	// that is, layouts are uniform (ships of same length are interchangeable)
+	class Layout_sampler {
+	public:
+		using Engine = Placement::Engine;
+
+		// Construction
+		Layout_sampler(const Placement& p, const std::vector<unsigned int>& ls, unsigned int depth = 3);
+
+		// Access to parameters (reading)
+		bool sample(std::vector<Ship_position>& res, Engine& ran, unsigned long long* attempts = nullptr) const;
+		const std::vector<unsigned int>& lengths() const { return lens; }
+		const std::vector<unsigned int>& acceptance_bounds() const { return bounds; }
+
+	private:
+		Placement plc;						// Copy of field (sampler may outlive placement it's made from)
+		std::vector<unsigned int> lens;		// Lengths of ships in order of placement
+		std::vector<unsigned int> bounds;	// Max numbers of legal positions for each ship
+		bool feasible;						// There is at least one legal layout
+
+		// Helper functions
+		unsigned int positions(unsigned int len, const Bitboard& forbidden) const;
+		void max_positions(unsigned int i, unsigned int depth, const Bitboard& forbidden);
+	};
+
+	//------------------------------------------------------------------------------
+
+}
+
+//------------------------------------------------------------------------------
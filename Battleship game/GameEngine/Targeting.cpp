@@ -0,0 +1,259 @@
+#include <algorithm>
+#include "Targeting.h"
+
+//------------------------------------------------------------------------------
+
+namespace Game_engine {
+
+	//------------------------------------------------------------------------------
+
+	// Determines cells touching cell i by angles only
+	Bitboard corners(const Placement& plc, unsigned int i)
+	{
+		Bitboard res;
+		for (Bitboard rest = plc.area(1, Orientation::horizontal, i); rest.any(); rest.reset(rest.front()))
+			if (rest.front() / plc.rows() != i / plc.rows() && rest.front() % plc.rows() != i % plc.rows())
+				res.set(rest.front());
+		return res;
+	}
+
+	// Determines cells of cells connected with cell i by sides or angles
+	Bitboard connected(const Placement& plc, const Bitboard& cells, unsigned int i)
+	{
+		Bitboard res = Bitboard::cell(i), grown = res;
+		do {
+			res = grown;
+			grown = plc.halo(res) & cells;
+		} while (grown != res);
+		return res;
+	}
+
+	//------------------------------------------------------------------------------
+
+	// Chooses random cell out of cells of field
+	unsigned int random_cell(const Bitboard& cells, Placement::Engine& ran)
+	{
+		if (cells.none())
+			throw std::runtime_error("Bad targeting: no cells to shot at");
+		return cells.nth(std::uniform_int_distribution<unsigned int>{ 0, cells.count() - 1 }(ran));
+	}
+
+	//------------------------------------------------------------------------------
+
+	// Constructs targeting of field of cols * rows, which chooses cells using r
+	Random_targeting::Random_targeting(unsigned int cols, unsigned int rows, Placement::Engine& r)
+		: plc{ cols, rows }, ran{ r }, shot{}
+	{
+	}
+
+	// Chooses random cell not shooted yet
+	unsigned int Random_targeting::choose()
+	{
+		return random_cell(plc.field() & ~shot, ran);
+	}
+
+	//------------------------------------------------------------------------------
+
+	// Constructs targeting of field of cols * rows, which chooses cells using r
+	Hunt_targeting::Hunt_targeting(unsigned int cols, unsigned int rows, Placement::Engine& r)
+		: plc{ cols, rows }, ran{ r }, shot{}, hit_inds{}
+	{
+	}
+
+	// Starts new game; lengths of ships aren't needed by hunting
+	void Hunt_targeting::reset(const std::vector<unsigned int>&)
+	{
+		shot.clear();
+		hit_inds.clear();
+	}
+
+	// Chooses random unknown cell if nothing is hitted, or random unknown side of random hitted cell
+	unsigned int Hunt_targeting::choose()
+	{
+		while (!hit_inds.empty()) {
+			const unsigned int ind = std::uniform_int_distribution<unsigned int>{ 0,
+				static_cast<unsigned int>(hit_inds.size()) - 1 }(ran);
+			const Bitboard sides = plc.area(1, Orientation::horizontal, hit_inds[ind]) &
+				~corners(plc, hit_inds[ind]) & ~shot;
+			if (sides.any())
+				return random_cell(sides, ran);
+			hit_inds.erase(hit_inds.begin() + ind);		// All cells around hitted one are shooted
+		}
+		return random_cell(plc.field() & ~shot, ran);
+	}
+
+	// Learns result res of shot at cell i
+	void Hunt_targeting::report(unsigned int i, Shot_result res)
+	{
+		shot.set(i);
+		if (res == Shot_result::miss)
+			return;
+		shot |= corners(plc, i);		// Cells touching hitted one by angles are empty
+		if (res == Shot_result::sunk)
+			hit_inds.clear();			// Nothing left to shot around sunken ship
+		else hit_inds.push_back(i);
+	}
+
+	//------------------------------------------------------------------------------
+
+	// Constructs targeting of field of cols * rows, which breaks ties using r
+	Density_targeting::Density_targeting(unsigned int cols, unsigned int rows, Placement::Engine& r)
+		: plc{ cols, rows }, ran{ r }, poss{}, covering{}, touching{}, built{}, left{}, dens{}, hit_dens{}, shot{}, hits{}
+	{
+	}
+
+	// Starts new game against fleet of ships of lengths lens
+	void Density_targeting::reset(const std::vector<unsigned int>& lens)
+	{
+		const unsigned int num = plc.columns() * plc.rows();
+		left.assign(lens.empty() ? 1 : *std::max_element(lens.begin(), lens.end()) + 1, 0);
+		for (unsigned int len : lens)
+			++left[len];
+		std::vector<bool> kinds(left.size());		// Lengths of ships in fleet
+		for (unsigned int len = 0; len < left.size(); ++len)
+			kinds[len] = left[len] > 0;
+		// Positions are kept between games against fleets of same kinds of ships
+		if (kinds != built) {
+			built = kinds;
+			poss.clear();
+			covering.assign(num, std::vector<unsigned int>{});
+			touching.assign(num, std::vector<unsigned int>{});
+			for (unsigned int len = 1; len < left.size(); ++len) {
+				if (!kinds[len])
+					continue;
+				for (unsigned int o = 0; o < (len > 1 ? 2u : 1u); ++o) {
+					const Orientation orient = static_cast<Orientation>(o);
+					for (Bitboard rest = plc.legal(len, orient, Bitboard{}); rest.any(); rest.reset(rest.front())) {
+						const Bitboard cells = plc.cells(len, orient, rest.front());
+						for (Bitboard c = cells; c.any(); c.reset(c.front()))
+							covering[c.front()].push_back(poss.size());
+						for (Bitboard c = plc.area(len, orient, rest.front()) & ~cells; c.any(); c.reset(c.front()))
+							touching[c.front()].push_back(poss.size());
+						poss.push_back(Position{ cells, len, 0, true });
+					}
+				}
+			}
+		}
+		// Nothing is known yet
+		shot.clear();
+		hits.clear();
+		dens.assign(num, 0);
+		hit_dens.assign(num, 0);
+		for (Position& pos : poss) {
+			pos.hits = 0;
+			pos.valid = true;
+			for (Bitboard c = pos.cells; c.any(); c.reset(c.front()))
+				dens[c.front()] += left[pos.len];
+		}
+	}
+
+	// Chooses unknown cell of highest density; cells next to hitted ones go first
+	unsigned int Density_targeting::choose()
+	{
+		const unsigned int i = best(hits.any() ? hit_dens : dens);
+		if (i != Bitboard::capacity)
+			return i;
+		return random_cell(plc.field() & ~shot, ran);		// None of positions is consistent
+	}
+
+	// Learns result res of shot at cell i
+	void Density_targeting::report(unsigned int i, Shot_result res)
+	{
+		if (shot.test(i) && !hits.test(i))		// Cell is known already
+			return;
+		if (res == Shot_result::miss) {
+			block(i);
+			return;
+		}
+		hit(i);
+		// Cells touching hitted one by angles are empty
+		for (Bitboard rest = corners(plc, i) & ~shot; rest.any(); rest.reset(rest.front()))
+			block(rest.front());
+		// Sunken ship consists of hitted cells connected with i (ships don't touch each other)
+		if (res == Shot_result::sunk)
+			sink(connected(plc, hits, i));
+	}
+
+	// Removes position p and its cells' densities
+	void Density_targeting::invalidate(unsigned int p)
+	{
+		Position& pos = poss[p];
+		if (!pos.valid)
+			return;
+		pos.valid = false;
+		for (Bitboard rest = pos.cells; rest.any(); rest.reset(rest.front())) {
+			dens[rest.front()] -= left[pos.len];
+			hit_dens[rest.front()] -= static_cast<long long>(left[pos.len]) * pos.hits;
+		}
+	}
+
+	// Marks cell i as known to be empty
+	void Density_targeting::block(unsigned int i)
+	{
+		shot.set(i);
+		for (unsigned int p : covering[i])
+			invalidate(p);
+	}
+
+	// Marks cell i as hitted
+	void Density_targeting::hit(unsigned int i)
+	{
+		if (hits.test(i))
+			return;
+		shot.set(i);
+		hits.set(i);
+		for (unsigned int p : touching[i])		// Ship at i would touch these positions
+			invalidate(p);
+		for (unsigned int p : covering[i]) {
+			Position& pos = poss[p];
+			if (!pos.valid)
+				continue;
+			++pos.hits;
+			for (Bitboard rest = pos.cells; rest.any(); rest.reset(rest.front()))
+				hit_dens[rest.front()] += left[pos.len];
+		}
+	}
+
+	// Removes sunken ship of cells ship from remaining ones and marks its around area as empty
+	void Density_targeting::sink(const Bitboard& ship)
+	{
+		const unsigned int len = ship.count();
+		hits &= ~ship;
+		if (len < left.size() && left[len] > 0) {
+			// One ship less of length len in every position
+			--left[len];
+			for (Position& pos : poss)
+				if (pos.valid && pos.len == len)
+					for (Bitboard rest = pos.cells; rest.any(); rest.reset(rest.front())) {
+						--dens[rest.front()];
+						hit_dens[rest.front()] -= pos.hits;
+					}
+		}
+		for (Bitboard rest = plc.halo(ship); rest.any(); rest.reset(rest.front()))
+			block(rest.front());
+	}
+
+	// Finds unknown cell of greatest positive density d, choosing randomly among equal ones;
+	// Bitboard::capacity if there is no such cell
+	unsigned int Density_targeting::best(const std::vector<long long>& d)
+	{
+		unsigned int res = Bitboard::capacity;
+		unsigned int ties = 0;		// Number of cells with greatest density so far
+		for (Bitboard rest = plc.field() & ~shot; rest.any(); rest.reset(rest.front())) {
+			const unsigned int i = rest.front();
+			if (d[i] <= 0 || (res != Bitboard::capacity && d[i] < d[res]))
+				continue;
+			if (res == Bitboard::capacity || d[i] > d[res])
+				ties = 0;
+			// Reservoir sampling among equal cells
+			if (std::uniform_int_distribution<unsigned int>{ 0, ties++ }(ran) == 0)
+				res = i;
+		}
+		return res;
+	}
+
+	//------------------------------------------------------------------------------
+
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,122 @@
+// Choice of cells to shoot at
+
+//------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include "Board.h"
+#include "Placement.h"
+
+//------------------------------------------------------------------------------
+
+namespace Game_engine {
+
+	//------------------------------------------------------------------------------
+
+	class Targeting {		// Strategy of shooting at unknown fleet
+	public:
+		virtual ~Targeting() { }
+
+		// Starts new game against fleet of ships of lengths lens
+		virtual void reset(const std::vector<unsigned int>& lens) = 0;
+		// Chooses cell to shoot at next
+		virtual unsigned int choose() = 0;
+		// Learns result res of shot at cell i
+		virtual void report(unsigned int i, Shot_result res) = 0;
+	};
+
+	// Helper functions
+	Bitboard corners(const Placement& plc, unsigned int i);
+	Bitboard connected(const Placement& plc, const Bitboard& cells, unsigned int i);
+	unsigned int random_cell(const Bitboard& cells, Placement::Engine& ran);
+
+	//------------------------------------------------------------------------------
+
+	class Random_targeting : public Targeting {		// Shooting at random cells not shooted yet
+	public:
+		// Construction
+		Random_targeting(unsigned int cols, unsigned int rows, Placement::Engine& r);
+
+		// Access to parameters (writing)
+		void reset(const std::vector<unsigned int>&) override { shot.clear(); }
+		unsigned int choose() override;
+		void report(unsigned int i, Shot_result) override { shot.set(i); }
+
+	private:
+		Placement plc;
+		Placement::Engine& ran;
+		Bitboard shot;		// Cells shooted at
+	};
+
+	//------------------------------------------------------------------------------
+
+	// Note: cells touching hitted ones by angles are known to be empty, but around areas of sunken ships aren't
+	class Hunt_targeting : public Targeting {	// Shooting at random cells, then at random sides of hitted ones
+	public:
+		// Construction
+		Hunt_targeting(unsigned int cols, unsigned int rows, Placement::Engine& r);
+
+		// Access to parameters (writing)
+		void reset(const std::vector<unsigned int>& lens) override;
+		unsigned int choose() override;
+		void report(unsigned int i, Shot_result res) override;
+
+	private:
+		Placement plc;
+		Placement::Engine& ran;
+		Bitboard shot;		// Cells shooted at or known to be empty
+		std::vector<unsigned int> hit_inds;		// Series of current hitted cells
+	};
+
+	//------------------------------------------------------------------------------
+
+	// Note: density of cell is number of positions of remaining ships covering cell, which are consistent
+	// with known cells; it is maintained incrementally, so each shot updates only positions it touches
+	class Density_targeting : public Targeting {	// Shooting at cells of highest density
+	public:
+		// Construction
+		Density_targeting(unsigned int cols, unsigned int rows, Placement::Engine& r);
+
+		// Access to parameters (writing)
+		void reset(const std::vector<unsigned int>& lens) override;
+		unsigned int choose() override;
+		void report(unsigned int i, Shot_result res) override;
+
+		// Access to parameters (reading)
+		long long density(unsigned int i) const { return dens[i]; }
+		long long hit_density(unsigned int i) const { return hit_dens[i]; }
+		const Bitboard& known() const { return shot; }
+
+	private:
+		struct Position {			// Position of ship
+			Bitboard cells;
+			unsigned int len;
+			unsigned int hits;		// Number of hitted cells covered
+			bool valid;				// Consistent with known cells
+		};
+
+		Placement plc;
+		Placement::Engine& ran;
+		std::vector<Position> poss;						// Positions of ships of all lengths
+		std::vector<std::vector<unsigned int>> covering;	// Positions covering each cell
+		std::vector<std::vector<unsigned int>> touching;	// Positions touching each cell by sides or angles
+		std::vector<bool> built;						// Lengths of ships which positions are built for
+		std::vector<unsigned int> left;					// Number of remaining ships of each length
+		std::vector<long long> dens;					// Density of each cell
+		std::vector<long long> hit_dens;				// Density weighted by number of hitted cells covered
+		Bitboard shot;		// Cells shooted at or known to be empty
+		Bitboard hits;		// Hitted cells of not sunken ships
+
+		// Helper functions
+		void invalidate(unsigned int p);
+		void block(unsigned int i);
+		void hit(unsigned int i);
+		void sink(const Bitboard& ship);
+		unsigned int best(const std::vector<long long>& d);
+	};
+
+	//------------------------------------------------------------------------------
+
+}
+
+//------------------------------------------------------------------------------
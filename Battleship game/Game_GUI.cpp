@@ -1,3 +1,4 @@
+#include <iostream>
 #include "Game_GUI.h"
 #include "RandGenerator/Generator.h"
 
@@ -15,6 +16,9 @@ namespace Graph_lib {
 	constexpr unsigned int h_num = 10;		// Number of horizontal lines
 	constexpr unsigned int v_num = 10;		// Number of vertical lines
 	constexpr unsigned int x_offset = 100;	// Offset by x-coordinate between grids
+	constexpr unsigned int menu_num = 4;	// Number of buttons of game menu
+	constexpr double shot_delay = 0.5;		// Delay before each target shot (in seconds)
+	constexpr auto sampling_budget = std::chrono::milliseconds(100);	// Time of Monte Carlo choice of shot
 	const Color frame = Color::Color_type::black;	// Color of frame
 	const Color empty = Color::Color_type::blue;	// Color of empty cell
 	const Color hit = Color::Color_type::red;		// Color of hitted cell
@@ -40,23 +44,44 @@ Number		Kind of ship		Size
 
 	//------------------------------------------------------------------------------
 
-	// Constructs window with top-left angle at xy, of size w * h, and labeled with lab
-	Battleship::Battleship(Point xy, unsigned int w, unsigned int h, const std::string& lab)
+	// Makes strategy of kind a shooting at field of game
+	std::unique_ptr<Game_engine::Targeting> make_ai(Battleship::Ai a)
+	{
+		switch (a) {
+		case Battleship::Ai::sampling:
+			return std::make_unique<Game_engine::Monte_carlo_targeting>(h_num, v_num, get_rand(), sampling_budget);
+		default:
+			return std::make_unique<Game_engine::Density_targeting>(h_num, v_num, get_rand());
+		}
+	}
+
+	// Constructs window with top-left angle at xy, of size w * h, and labeled with lab;
+	// target shoots with strategy of kind a
+	Battleship::Battleship(Point xy, unsigned int w, unsigned int h, const std::string& lab, Ai a)
 		: Window{ xy, cell_w * (h_num * 2 + 2) + x_offset, cell_h * (v_num + 2), lab },
 		game_menu{ Point{ 0, 0 }, but_w, but_h, Menu::Kind::horizontal, "" },
 		menu_but{ Point{ 0, 0 }, but_w, but_h, "Game menu", cb_menu },
 		restart_but{ Point{ 0, 0 }, 0, 0, "New game", cb_restart },
+		density_but{ Point{ 0, 0 }, 0, 0, "Density AI", cb_ai, static_cast<unsigned int>(Ai::density) },
+		sampling_but{ Point{ 0, 0 }, 0, 0, "Sampling AI", cb_ai, static_cast<unsigned int>(Ai::sampling) },
 		quit_but{ Point{ 0, 0 }, 0, 0, "Quit", cb_quit },
 		help_but{ Point{ but_w, 0 }, but_w, but_h, "Help", cb_help },
 		help_box{ Point{ 0, but_h }, cell_w * (h_num * 2 + 2) + x_offset, cell_h * (v_num + 2) - but_h, "" },
 		target_group{ Point{ cell_w * (h_num + 2) + x_offset, cell_h * 2 }, cell_w, cell_h, h_num, v_num, "", cb_cell },
 		player_field{ Point{ cell_w, cell_h * 2 }, cell_w, cell_h, h_num, v_num, marks },
 		target_field{ Point{ cell_w * (h_num + 2) + x_offset, cell_h * 2 }, cell_w, cell_h, h_num, v_num, marks },
-		player{ Point{ cell_w, cell_h * 2 }, cell_w * h_num, cell_h * v_num, cell_w, cell_h },
-		target{ Point{ cell_w * (h_num + 2) + x_offset, cell_h * 2 }, cell_w * h_num, cell_h * v_num, cell_w, cell_h }
+		player_frame{ Point{ cell_w, cell_h * 2 }, cell_w, cell_h, h_num, v_num, marks },
+		target_frame{ Point{ cell_w * (h_num + 2) + x_offset, cell_h * 2 }, cell_w, cell_h, h_num, v_num, marks },
+		player{ Point{ cell_w, cell_h * 2 }, cell_w * h_num, cell_h * v_num, cell_w, cell_h, &arena },
+		target{ Point{ cell_w * (h_num + 2) + x_offset, cell_h * 2 }, cell_w * h_num, cell_h * v_num, cell_w, cell_h, &arena },
+		level{ a }, ai{ make_ai(a) },
+		turn{ Turn::player }, round{ 0 }, worker{}, self{ std::make_shared<Battleship*>(this) }, lost{ false }
 	{
+		Fl::add_check(cb_lost, this);	// Look for lost shots at each loop of events
 		// Connection of buttons and menu
 		game_menu.attach(restart_but);
+		game_menu.attach(density_but);
+		game_menu.attach(sampling_but);
 		game_menu.attach(quit_but);
 		// Connection of widgets and window
 		attach(target_group);
@@ -65,24 +90,46 @@ Number		Kind of ship		Size
 		attach(help_but);
 		attach(help_box);
 		// Connection of graphics and window
-		attach(player_field);
-		attach(target_field);
-		attach(player);
-		attach(target);
+		attach_static(player_frame);
+		attach_static(target_frame);
+		attach(player_field, Layer::boards);
+		attach(target_field, Layer::boards);
+		attach(player, Layer::ships);
+		attach(target, Layer::ships);
 		// Initial parameters of widgets
 		game_menu.hide();
+		ai_button(level).deactivate();		// Chosen strategy can't be chosen again
 		help_box.hide();
 		help_box.put(help_msg);
-		// Initial parameters of graphics
+		// Initial parameters of graphics (fields keep color of lines to leave them to frames)
+		player_frame.set_layer(Grid::Layer::lines);
+		player_frame.set_color(frame);
+		target_frame.set_layer(Grid::Layer::lines);
+		target_frame.set_color(frame);
+		player_field.set_layer(Grid::Layer::fills);
 		player_field.set_color(frame);
 		player_field.set_fill_color(empty);
+		target_field.set_layer(Grid::Layer::fills);
 		target_field.set_color(frame);
 		target_field.set_fill_color(empty);
+		// Changed cells of fields are redrawn at next drawing
+		player_field.set_damage([this](Box b) { invalidate(b); });
+		target_field.set_damage([this](Box b) { invalidate(b); });
 		player.set_color(miss);
 		target.set_color(miss);
 		target.set_visibility(Color::Transparency::invisible);
 		player.random_location();
 		target.random_location();
+		reindex(player);		// Fleets were moved out of index's sight
+		reindex(target);
+		ai->reset(player.lengths());
+	}
+
+	// Destructs window after choice of target's shot is finished
+	Battleship::~Battleship()
+	{
+		Fl::remove_check(cb_lost, this);
+		wait_worker();
 	}
 
 	// Calls action function of menu button
@@ -91,10 +138,10 @@ Number		Kind of ship		Size
 		reference_to<Battleship>(own).menu();
 	}
 
-	// Calls action function of cell button
-	void Battleship::cb_cell(Address pw, Address own)
+	// Calls action function of cell button i
+	void Battleship::cb_cell(Address pw, Address own, unsigned int i)
 	{
-		reference_to<Battleship>(own).cell(pw);
+		reference_to<Battleship>(own).cell(i);
 	}
 
 	// Calls action function of restart and menu buttons
@@ -104,6 +151,13 @@ Number		Kind of ship		Size
 		reference_to<Battleship>(own).menu();
 	}
 
+	// Calls action function of strategy buttons (a is kind of strategy) and menu button
+	void Battleship::cb_ai(Address pw, Address own, unsigned int a)
+	{
+		reference_to<Battleship>(own).select_ai(static_cast<Ai>(a));
+		reference_to<Battleship>(own).menu();
+	}
+
 	// Calls action function of quit and menu buttons
 	void Battleship::cb_quit(Address pw, Address own)
 	{
@@ -117,6 +171,26 @@ Number		Kind of ship		Size
 		reference_to<Battleship>(own).help();
 	}
 
+	// Schedules action function of target's shot chosen on worker thread (called by event loop)
+	void Battleship::cb_target(void* move)
+	{
+		const std::unique_ptr<Target_move> m{ static_cast<Target_move*>(move) };
+		if (m->alive.expired()) return;		// Ignore shots posted to destroyed game
+		Battleship& game = *m->game;
+		if (!m->error.empty())
+			std::cerr << "Target's shot isn't chosen: " << m->error << '\n';
+		const unsigned int r = m->round, i = m->ind;
+		game.schedule(shot_delay, [&game, r, i]() { game.target_moved(r, i); });
+	}
+
+	// Chooses target's shot again if chosen one couldn't be posted (called by event loop)
+	void Battleship::cb_lost(void* game)
+	{
+		Battleship& g = *static_cast<Battleship*>(game);
+		if (g.lost.exchange(false) && g.turn == Turn::target)
+			g.target_shot();
+	}
+
 	// Hides menu button and shows game menu or vice versa
 	void Battleship::menu()
 	{
@@ -124,31 +198,34 @@ Number		Kind of ship		Size
 		if (menu_but.visible()) {
 			menu_but.hide();
 			game_menu.show();
-			help_but.move(static_cast<int>(but_w), 0);
+			help_but.move(static_cast<int>(but_w * (menu_num - 1)), 0);
 		}
 		// Hide game menu and show menu button
 		else {						// Invisible menu button
 			game_menu.hide();
 			menu_but.show();
-			help_but.move(-static_cast<int>(but_w), 0);
+			help_but.move(-static_cast<int>(but_w * (menu_num - 1)), 0);
 		}
 	}
 
-	// Deactivates and updates state of cell at address of pw
-	void Battleship::cell(Address pw)
+	// Deactivates and updates state of cell i of target group; ignored out of player's turn
+	void Battleship::cell(unsigned int i)
 	{
-		for (unsigned int i = 0; i < target_group.selection.size(); ++i)
-			if (target_group.selection[i].widget() == pw) {
-				target_group.selection[i].deactivate();
-				return player_shot(i);			// Update state of correspondent cell
-			}
+		if (turn != Turn::player) return;
+		target_group.deactivate(i);
+		player_shot(i);			// Update state of correspondent cell
 	}
 
 	// Redefines parameters of game as at its start
 	void Battleship::restart()
 	{
+		wait_worker();			// Shot of previous game is dropped
+		lost = false;
+		cancel_scheduled();
+		++round;
+		turn = Turn::player;
 		target_group.activate();			// Initial parameters of widgets
-		// Initial parameters of graphics
+		// Initial parameters of graphics (only fields are redrawn, fleets are located inside of them)
 		player_field.set_fill_color(empty);
 		target_field.set_fill_color(empty);
 		target.set_visibility(Color::Transparency::invisible);
@@ -156,7 +233,21 @@ Number		Kind of ship		Size
 		target.restore();
 		player.random_location();
 		target.random_location();
-		Window::redraw();
+		reindex(player);		// Fleets were moved out of index's sight
+		reindex(target);
+		ai->reset(player.lengths());
+	}
+
+	// Replaces strategy of target with strategy of kind a, and starts new game,
+	// as new strategy knows nothing about shots of current game
+	void Battleship::select_ai(Ai a)
+	{
+		wait_worker();			// Old strategy may be choosing shot
+		ai_button(level).activate();
+		level = a;
+		ai = make_ai(level);
+		ai_button(level).deactivate();
+		restart();
 	}
 
 	// Closes game window
@@ -171,38 +262,28 @@ Number		Kind of ship		Size
 		// Hide help box and enable player to play game
 		if (help_box.visible()) {
 			restart_but.activate();
+			ai_button(level == Ai::density ? Ai::sampling : Ai::density).activate();
 			target_group.show();
 			help_box.hide();
 			// Show graphics
-			player_field.set_visibility(Color::Transparency::visible);
-			target_field.set_visibility(Color::Transparency::visible);
-			player.set_visibility(Color::Transparency::visible);
-			player.set_fill_color(Color::Transparency::invisible);
-			if (target.is_sunk() || player.is_sunk()) {		// Game ended
-				// Show target fleet
-				target.set_visibility(Color::Transparency::visible);
-				target.set_fill_color(Color::Transparency::invisible);
-			}
+			show_layer(Layer::background);
+			show_layer(Layer::boards);
+			show_layer(Layer::ships);
 		}
 		// Show help box and disable player to play game
 		else {							// Invisible help box
 			restart_but.deactivate();
+			density_but.deactivate();
+			sampling_but.deactivate();
 			help_box.show();
 			target_group.hide();
-			// Hide graphics
-			player_field.set_visibility(Color::Transparency::invisible);
-			target_field.set_visibility(Color::Transparency::invisible);
-			player.set_visibility(Color::Transparency::invisible);
-			target.set_visibility(Color::Transparency::invisible);
+			// Hide graphics (hidden layers aren't drawn at all)
+			hide_layer(Layer::background);
+			hide_layer(Layer::boards);
+			hide_layer(Layer::ships);
 		}
-		Window::redraw();
 	}
 
-	enum class Direction {		// Directions from cell
-		left = 0, top_left = 1, up = 2, top_right = 3,
-		right = 4, down_right = 5, down = 6, down_left = 7
-	};
-
 	// Finds next index from ind directed in direction of dir;
 	// ind for invalid directions and out of range access
 	unsigned int next_index(unsigned int ind, Direction dir)
@@ -230,69 +311,66 @@ Number		Kind of ship		Size
 	}
 
 	// Determines either cell is empty or not
-	bool is_empty_cell(const Rectangle& cell)
+	bool is_empty_cell(Grid::Const_cell cell)
 	{
 		return cell.fill_color().as_int() == empty.as_int();
 	}
 
-	// Finds index of next empty cell directed from cell indexed with ind in field
-	unsigned int next_empty_index(const Marked_grid& field, unsigned int ind)
+	// Starts choice of target's shot at player field on worker thread; chosen
+	// shot is posted to event loop, so window isn't blocked while ai thinks
+	void Battleship::target_shot()
 	{
-		// Possible directions from cell
-		std::vector<Direction> directs{ Direction::left, Direction::up, Direction::right, Direction::down };
-		std::random_shuffle(directs.begin(), directs.end());
-		for (unsigned int i = 0; i < directs.size(); ++i)
-			if (is_empty_cell(field[next_index(ind, directs[i])]))
-				return next_index(ind, directs[i]);
-		return ind;			// None of cells is empty
+		wait_worker();
+		Target_move* move = new Target_move{ this, self, round, h_num * v_num, "" };
+		worker = std::thread{ [this, move]() {
+			try {
+				move->ind = ai->choose();		// Index of next shooted cell
+			}
+			catch (const std::exception& e) {	// Shot isn't chosen (reported by event loop)
+				move->error = e.what();
+			}
+			if (Fl::awake(cb_target, move) != 0) {	// Handle of full queue of event loop
+				delete move;
+				lost = true;		// Event loop is busy with queue, so it'll see it soon (cb_lost)
+			}
+		} };
 	}
 
-	// Updates state of empty cell in player field
-	void Battleship::target_shot()
+	// Shots at cell indexed with ind of player field; passes turn to player if missed
+	void Battleship::target_moved(unsigned int r, unsigned int ind)
 	{
-		Ship_cell::State res_shot = Ship_cell::State::miss;		// Result of next shot
-		unsigned int ind = 0;									// Index of next shooted cell
-		static std::vector<unsigned int> hit_inds;				// Serie of current hitted cells		
-		// Shot at random cell
-		if (hit_inds.size() == 0) {
-			do ind = randint(player_field.size() - 1);
-			while (!is_empty_cell(player_field[ind]));
+		wait_worker();
+		if (r != round || turn != Turn::target) return;		// Handle of outdated shot
+		// Handle of failed choice: ai fails only if it has no cells to shot at, which means broken
+		// strategy rather than state of game, so player keeps playing instead of waiting forever
+		if (ind >= h_num * v_num) {
+			turn = Turn::player;
+			return;
 		}
-		else {	// Shot at around area of hitted ship
-			ind = randint(hit_inds.size() - 1);
-			// All cells in around area of next cell are shooted
-			if (next_empty_index(player_field, hit_inds[ind]) == hit_inds[ind]) {
-				hit_inds.erase(std::next(hit_inds.begin(), ind));
-				return target_shot();
-			}
-			ind = next_empty_index(player_field, hit_inds[ind]);
-		}
-		res_shot = player.shot(player_field[ind].point(0));		// Shot at correspondent cell
+		const Ship_cell::State res_shot = player.shot(player_field[ind].point(0));	// Shot at correspondent cell
+		ai->report(ind, res_shot);
 		render(player_field, ind, res_shot);
 		// Continue to shot if hitted
-		if (res_shot == Ship_cell::State::hit && !update()) {
-			hit_inds.push_back(ind);
-			return target_shot();
-		}
+		if (res_shot == Ship_cell::State::miss)
+			turn = Turn::player;
+		else if (!update())
+			target_shot();
 	}
 
-	// Updates state of cell indexed with ind in target field
+	// Updates state of cell indexed with ind in target field; passes turn to target if missed
 	void Battleship::player_shot(unsigned int ind)
 	{
-		static Ship_cell::State res_shot = Ship_cell::State::hit;	// Result of next shot
-		// Continue to shot if hitted
-		if (res_shot == Ship_cell::State::hit) {
-			res_shot = target.shot(target_field[ind].point(0));		// Shot at correspondent cell
-			render(target_field, ind, res_shot);
-			// Pass turn to shot to target if missed
-			if (res_shot == Ship_cell::State::miss)
-				target_shot();
-			else {
-				around_area(ind);
-				update();
-			}
+		const Ship_cell::State res_shot = target.shot(target_field[ind].point(0));	// Shot at correspondent cell
+		render(target_field, ind, res_shot);
+		// Pass turn to shot to target if missed
+		if (res_shot == Ship_cell::State::miss) {
+			turn = Turn::target;
+			target_shot();
+		}
+		else {
+			around_area(ind);
+			update();
 		}
-		res_shot = Ship_cell::State::hit;		// Pass turn to shot to player
 	}
 
 	// Updates state of game; true if game is over
@@ -300,10 +378,12 @@ Number		Kind of ship		Size
 	{
 		// Check for winner in battle
 		if (target.is_sunk() || player.is_sunk()) {
+			turn = Turn::over;
 			target_group.deactivate();
 			// Show target fleet
 			target.set_visibility(Color::Transparency::visible);
 			target.set_fill_color(Color::Transparency::invisible);
+			invalidate(target);
 			return true;
 		}
 		return false;
@@ -313,23 +393,29 @@ Number		Kind of ship		Size
 	void Battleship::around_area(unsigned int ind)
 	{
 		for (int i = static_cast<int>(Direction::top_left); i <= static_cast<int>(Direction::down_left); i += 2)
-			if (target_group.selection[next_index(ind, static_cast<Direction>(i))].active())
-				target_group.selection[next_index(ind, static_cast<Direction>(i))].deactivate();
+			target_group.deactivate(next_index(ind, static_cast<Direction>(i)));
 	}
 
-	// Renders shots at cell indexed with ind in field
+	// Renders shots at cell indexed with ind in field; only changed cells are redrawn
 	void Battleship::render(Marked_grid& field, unsigned int ind, Ship_cell::State shot)
 	{
 		// Render correspondent cell consider to its state
-		if (shot == Ship_cell::State::hit) {
+		if (shot != Ship_cell::State::miss) {
 			field[ind].set_fill_color(Color::Color_type::red);
 			// Render around area of hitted cell
-			for (int i = static_cast<int>(Direction::top_left); i <= static_cast<int>(Direction::down_left); i += 2)
-				if (is_empty_cell(field[next_index(ind, static_cast<Direction>(i))]))
-					field[next_index(ind, static_cast<Direction>(i))].set_fill_color(Color::Color_type::white);
+			for (int i = static_cast<int>(Direction::top_left); i <= static_cast<int>(Direction::down_left); i += 2) {
+				Grid::Cell cell = field[next_index(ind, static_cast<Direction>(i))];
+				if (is_empty_cell(cell))
+					cell.set_fill_color(Color::Color_type::white);
+			}
 		}
 		else field[ind].set_fill_color(Color::Color_type::white);
-		Window::redraw();
+	}
+
+	// Waits for worker thread to finish choice of target's shot
+	void Battleship::wait_worker()
+	{
+		if (worker.joinable()) worker.join();
 	}
 
 	//------------------------------------------------------------------------------
@@ -1,50 +1,109 @@
 #pragma once
+#include <memory>
+#include <thread>
+#include <atomic>
 #include "GraphicsLib/GUI.h"
 #include "Game_graph.h"
+#include "GameEngine/Targeting.h"
+#include "GameEngine/Monte_carlo.h"
 
 //------------------------------------------------------------------------------
 
 namespace Graph_lib {
 
 	// Invariant: w >= 0, h >= 0
+	// Note: target's shots are posted from worker thread, so Fl::lock() must be called before game is run
 	class Battleship : public Window {
 	public:
+		enum class Ai {		// Strategies of target's shots
+			density, sampling
+		};
+
 		// Construction
-		Battleship(Point xy, unsigned int w, unsigned int h, const std::string& lab);
+		Battleship(Point xy, unsigned int w, unsigned int h, const std::string& lab, Ai a = Ai::density);
+
+		// Destruction
+		~Battleship();
+
+		// Drawing of graphics
+		using Window::render;
 
 	private:
+		enum class Turn {		// States of game
+			player, target, over
+		};
+
+		struct Target_move {	// Shot chosen by ai on worker thread
+			Battleship* game;
+			std::weak_ptr<Battleship*> alive;	// Expires when game is destroyed
+			unsigned int round;		// Round of game, which shot is chosen for
+			unsigned int ind;		// Index of cell (size of field if ai failed)
+			std::string error;		// Reason of failure of ai
+		};
+
 		// Callback functions
 		static void cb_menu(Address pw, Address own);
-		static void cb_cell(Address pw, Address own);
+		static void cb_cell(Address pw, Address own, unsigned int i);
 		static void cb_restart(Address pw, Address own);
+		static void cb_ai(Address pw, Address own, unsigned int a);
 		static void cb_quit(Address pw, Address own);
 		static void cb_help(Address pw, Address own);
+		static void cb_target(void* move);
+		static void cb_lost(void* game);
 
 		// Action functions
 		void menu();
-		void cell(Address pw);
+		void cell(unsigned int i);
 		void restart();
+		void select_ai(Ai a);
 		void quit();
 		void help();
 		void target_shot();
+		void target_moved(unsigned int round, unsigned int i);
 		void player_shot(unsigned int i);
 		bool update();
 		void around_area(unsigned int i);
 		void render(Marked_grid& grid, unsigned int i, Ship_cell::State shot);
 
+		Arena arena;			// Owner of ships of fleets
 		// Widgets
 		Menu game_menu;			// Menu of new game button and quit button
 		Button menu_but;		// Menu button
 		Button restart_but;		// New game button
+		Button density_but;		// Button of density strategy (starts new game)
+		Button sampling_but;	// Button of Monte Carlo strategy (starts new game)
 		Button quit_but;		// Quit button
 		Button help_but;		// Help button
 		Text_box help_box;
-		Group target_group;		// Group of buttons (cells)
+		Button_matrix target_group;		// Matrix of buttons (cells)
 		// Graphics
-		Marked_grid player_field, target_field;
+		Marked_grid player_field, target_field;		// Fills of cells
+		Marked_grid player_frame, target_frame;		// Lines and marks of fields (static layer)
 		Fleet player, target;
+		// Opponent
+		Ai level;			// Kind of strategy
+		std::unique_ptr<Game_engine::Targeting> ai;		// Strategy of target's shots at player fleet
+		// State of game
+		Turn turn;
+		unsigned int round;			// Number of game since start (outdates choices of previous games)
+		std::thread worker;			// Thread choosing target's shots
+		std::shared_ptr<Battleship*> self;	// Address of game for posted shots
+		std::atomic<bool> lost;		// Chosen shot couldn't be posted to event loop
+
+		// Helper functions
+		void wait_worker();			// Wait for end of choice of target's shot
+		Button& ai_button(Ai a) { return a == Ai::density ? density_but : sampling_but; }
+	};
+
+	enum class Direction {		// Directions from cell
+		left = 0, top_left = 1, up = 2, top_right = 3,
+		right = 4, down_right = 5, down = 6, down_left = 7
 	};
 
+	// Helper functions
+	unsigned int next_index(unsigned int ind, Direction dir);
+	bool is_empty_cell(Grid::Const_cell cell);
+
 }
 
 //------------------------------------------------------------------------------
\ No newline at end of file
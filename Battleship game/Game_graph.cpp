@@ -24,11 +24,12 @@ namespace Graph_lib {
 		lab.move(-static_cast<int>(cell_w / 2), -static_cast<int>(cell_h / 2));
 	}
 
-	// Draws grid and marks of marked grid
+	// Draws grid and marks of marked grid; marks are drawn with lines of grid
 	void Marked_grid::draw_lines() const
 	{
 		Grid::draw_lines();		// Draw grid
-		lab.draw();
+		if (layer() != Layer::fills)
+			lab.draw();
 	}
 
 	// Sets c as color of grid and marks
@@ -47,18 +48,18 @@ namespace Graph_lib {
 
 	//------------------------------------------------------------------------------
 
-	// Constructs ship with top-left angle of head at xy, of cell_w * cell_h
-	// size for each cell, of kind k, and oriented with o
-	Ship::Ship(Point xy, unsigned int cell_w, unsigned int cell_h, Kind k, Orientation o)
-		: kind{ k }, orient{ Orientation::horizontal }
+	// Constructs ship with top-left angle of head at xy, of cell_w * cell_h size for
+	// each cell, of kind k, and oriented with o; cells are owned by a (if not null)
+	Ship::Ship(Point xy, unsigned int cell_w, unsigned int cell_h, Kind k, Orientation o, Arena* a)
+		: cells{ a }, kind{ k }, orient{ Orientation::horizontal }, brd{ nullptr }, id{ 0 }
 	{
 		// Fill of cells using horizontal orientation
 		for (unsigned int i = 0; i < static_cast<unsigned int>(kind); ++i)
-			cells.push_back(new Ship_cell
-				{ Point{ static_cast<int>(xy.x + cell_w * i), xy.y }, cell_w, cell_h });
+			cells.make_back(Point{ static_cast<int>(xy.x + cell_w * i), xy.y }, cell_w, cell_h);
 		if (o == Orientation::vertical)		// Rotate if not guess orientation
 			rotate();
 		add(xy);		// Top-left angle of head
+		update_area();
 	}
 
 	// Draws cells of ship
@@ -68,26 +69,6 @@ namespace Graph_lib {
 			cells[i].draw();
 	}
 
-	// Marks ship's cell if shot resulted in hit; returns result of shot (hit or miss);
-	// Shot considered to be successful if passed point has same location as one of ship's cells
-	Ship_cell::State Ship::shot(Point xy)
-	{
-		// Check for result of shot
-		for (unsigned int i = 0; i < cells.size(); ++i)
-			if (cells[i].point(0) == xy) {
-				cells[i].state = Ship_cell::State::hit;		// Mark hitted cell
-				return Ship_cell::State::hit;
-			}
-		return Ship_cell::State::miss;
-	}
-
-	// Marks all cells of ship as missed
-	void Ship::restore()
-	{
-		for (unsigned int i = 0; i < cells.size(); ++i)
-			cells[i].state = Ship_cell::State::miss;
-	}
-
 	// Rotates ship to opposite orientation (i.e., horizontal => vertical)
 	void Ship::rotate()
 	{
@@ -99,6 +80,7 @@ namespace Graph_lib {
 		// Rotation of cells
 		for (unsigned int i = 0; i < cells.size(); ++i)
 			cells[i].move(dx * i, dy * i);
+		update_area();
 	}
 
 	// Sets c as line color for cells of ship
@@ -123,6 +105,7 @@ namespace Graph_lib {
 		Shape::set_style(ls);		// Update line style of shape
 		for (unsigned int i = 0; i < cells.size(); ++i)
 			cells[i].set_style(ls);
+		update_area();				// Width of lines widens cells
 	}
 
 	// Sets vis as visibility for cells of ship
@@ -139,16 +122,22 @@ namespace Graph_lib {
 		Shape::move(dx, dy);		// Update location of shape
 		for (unsigned int i = 0; i < cells.size(); ++i)
 			cells[i].move(dx, dy);
+		area.x += dx;
+		area.y += dy;
 	}
 
 	// Determines either all cells of ship are hitted or not
 	bool Ship::is_sunk() const
 	{
-		// Check for any missed cells in ship
+		return brd != nullptr && brd->is_sunk(id);
+	}
+
+	// Determines box of all cells of ship
+	void Ship::update_area()
+	{
+		area = Box{};
 		for (unsigned int i = 0; i < cells.size(); ++i)
-			if (cells[i].state == Ship_cell::State::miss)
-				return false;
-		return true;
+			area |= cells[i].bounds();
 	}
 
 	//------------------------------------------------------------------------------
@@ -156,25 +145,31 @@ namespace Graph_lib {
 	// Constant
 	constexpr unsigned int num_of_ships = 10;		// Number of ships in fleet
 
-	// Constructs fleet with top-left angle of its frame at xy, of
-	// its size ww * hh, and of size cell_w * cell_h for each cell
-	Fleet::Fleet(Point xy, unsigned int ww, unsigned int hh, unsigned int cell_w, unsigned int cell_h)
-		: fleet{}, w{ ww / cell_w > num_of_ships ? ww : cell_w * num_of_ships },
-		h{ hh / cell_h > num_of_ships ? hh : cell_h * num_of_ships }
+	// Constructs fleet with top-left angle of its frame at xy, of its size ww * hh, and
+	// of size cell_w * cell_h for each cell; ships are owned by a (if not null);
+	// ships are stacked at xy, so board is empty until they are located
+	Fleet::Fleet(Point xy, unsigned int ww, unsigned int hh, unsigned int cell_w, unsigned int cell_h, Arena* a)
+		: fleet{ a }, w{ ww / cell_w > num_of_ships ? ww : cell_w * num_of_ships },
+		h{ hh / cell_h > num_of_ships ? hh : cell_h * num_of_ships }, brd{ w / cell_w, h / cell_h },
+		plc{ w / cell_w, h / cell_h }
 	{
 		// Fill of fleet with ships
 		using Kind = Ship::Kind; using Orient = Ship::Orientation;
 		for (int i = static_cast<int>(Kind::Battleship); i >= static_cast<int>(Kind::Torpedo_boat); --i)
 			for (int j = i; j <= static_cast<int>(Kind::Battleship); ++j)
-				fleet.push_back(new Ship{ xy, cell_w, cell_h, static_cast<Kind>(i), Orient::horizontal });
+				fleet.make_back(xy, cell_w, cell_h, static_cast<Kind>(i), Orient::horizontal, a);
 		add(xy);		// Top-left angle of frame
+		update_area();
 	}
 
-	// Draws ships of fleet
+	// Draws ships of fleet; cells of all ships are drawn together
 	void Fleet::draw_lines() const
 	{
+		batch.clear();
 		for (unsigned int i = 0; i < fleet.size(); ++i)
-			fleet[i].draw();
+			for (unsigned int j = 0; j < static_cast<unsigned int>(fleet[i].ship_kind()); ++j)
+				batch.push_back(&fleet[i][j]);
+		draw_batch(batch);
 	}
 
 	//------------------------------------------------------------------------------
@@ -211,66 +206,89 @@ namespace Graph_lib {
 		return false;
 	}
 
-	// Rotates ship randomly
-	void random_rotate(Ship& ship)
-	{
-		static constexpr int leave = 0, rotate = 1;		// Keys for random rotation
-		if (randint(leave, rotate) == rotate)
-			ship.rotate();
-	}
-
 	// Moves ship to xy
 	void move_to(Ship& ship, Point xy)
 	{
 		ship.move(xy.x - ship.point(0).x, xy.y - ship.point(0).y);
 	}
 
-	// Moves ship randomly in frame with top-left angle at xy, and of size w * h
-	void random_move(Ship& ship, Point xy, unsigned int w, unsigned int h)
-	{
-
-		// Size of ship
-		const unsigned int cell_w = ship.cell_width(), cell_h = ship.cell_height(),
-			ship_w = ship.orientation() == Ship::Orientation::horizontal ?
-			cell_w * static_cast<int>(ship.ship_kind()) : cell_w,
-			ship_h = ship.orientation() == Ship::Orientation::vertical ?
-			cell_h * static_cast<int>(ship.ship_kind()) : cell_h;
-		// Random x and y coordinates
-		const int rand_x = xy.x + cell_w * randint(0, static_cast<int>((w - ship_w) / cell_w)),
-			rand_y = xy.y + cell_h * randint(0, static_cast<int>((h - ship_h) / cell_h));
-		move_to(ship, Point{ rand_x, rand_y });     // Move to random point
-	}
-
 	//------------------------------------------------------------------------------
 
 	// Locates ships of fleet randomly inside frame in such way that
 	// none of them are overlapped by each other with their sides
 	void Fleet::random_location()
 	{
+		random_location(get_rand());
+	}
+
+	// Locates ships of fleet randomly inside frame using ran;
+	// returns number of positions abandoned by backtracking (retries)
+	unsigned long long Fleet::random_location(Game_engine::Placement::Engine& ran)
+	{
+		const std::vector<unsigned int> lens = lengths();
+		std::vector<Game_engine::Ship_position> pos;
+		unsigned long long retries = 0;
+		if (!plc.random_layout(lens, pos, ran, &retries))		// Handle of too small frame
+			throw std::runtime_error("Bad Fleet: no room to locate ships");
+		// Move ships to chosen positions
+		const int cell_w = static_cast<int>(fleet.front().cell_width()),
+			cell_h = static_cast<int>(fleet.front().cell_height());
 		for (unsigned int i = 0; i < fleet.size(); ++i) {
-			do { // Relocate ship while it's overlapped by other ships
-				random_rotate(fleet[i]);
-				random_move(fleet[i], point(0), w, h);
-			} while (std::find_if(fleet.cbegin(), std::next(fleet.cbegin(), i), [this, i](const Ship* s)
-				{ return is_overlap(fleet[i], *s); }) != std::next(fleet.cbegin(), i));
+			const Ship::Orientation o = pos[i].orient == Game_engine::Orientation::horizontal ?
+				Ship::Orientation::horizontal : Ship::Orientation::vertical;
+			if (fleet[i].orientation() != o)
+				fleet[i].rotate();
+			move_to(fleet[i], Point{ point(0).x + cell_w * static_cast<int>(pos[i].anchor / plc.rows()),
+				point(0).y + cell_h * static_cast<int>(pos[i].anchor % plc.rows()) });
 		}
+		update_board();			// Updates box of fleet too
+		return retries;
 	}
 
-	// Shots at each ship of fleet untill first hit
+	// Shots at cell of frame with top-left angle at xy; returns result of shot (hit, sunk or miss);
+	// Shot considered to be successful if passed point has same location as one of ships' cells
 	Ship_cell::State Fleet::shot(Point xy)
 	{
-		// Search for first hitted ship
-		for (unsigned int i = 0; i < fleet.size(); ++i)
-			if (fleet[i].shot(xy) == Ship_cell::State::hit)
-				return Ship_cell::State::hit;
-		return Ship_cell::State::miss;
+		const int cell_w = static_cast<int>(fleet.front().cell_width()),
+			cell_h = static_cast<int>(fleet.front().cell_height());
+		const int dx = xy.x - point(0).x, dy = xy.y - point(0).y;	// Offset from top-left angle of frame
+		// Handle of points out of frame or out of cells' angles
+		if (dx < 0 || dy < 0 || dx % cell_w != 0 || dy % cell_h != 0)
+			return Ship_cell::State::miss;
+		const unsigned int col = dx / cell_w, row = dy / cell_h;
+		if (col >= brd.columns() || row >= brd.rows())
+			return Ship_cell::State::miss;
+		return brd.shot(brd.index(col, row));
 	}
 
-	// Restores all ships of fleet
+	// Marks all cells of frame as not shot
 	void Fleet::restore()
 	{
+		brd.restore();
+	}
+
+	// Updates board and box of fleet with current location of ships;
+	// call it after any ship of fleet was moved or rotated by itself
+	void Fleet::update_board()
+	{
+		const int cell_w = static_cast<int>(fleet.front().cell_width()),
+			cell_h = static_cast<int>(fleet.front().cell_height());
+		std::vector<Game_engine::Bitboard> cells(fleet.size());		// Cells of frame occupied by each ship
 		for (unsigned int i = 0; i < fleet.size(); ++i)
-			fleet[i].restore();
+			for (unsigned int j = 0; j < static_cast<unsigned int>(fleet[i].ship_kind()); ++j) {
+				const int dx = fleet[i][j].point(0).x - point(0).x, dy = fleet[i][j].point(0).y - point(0).y;
+				if (dx < 0 || dy < 0 || dx / cell_w >= static_cast<int>(brd.columns()) ||
+					dy / cell_h >= static_cast<int>(brd.rows()))		// Handle of ships out of frame
+					throw std::out_of_range("Bad Fleet: ship " + std::to_string(i) + " is out of frame");
+				cells[i].set(brd.index(dx / cell_w, dy / cell_h));
+			}
+		// Board is changed only if all ships are inside of frame
+		brd.clear_ships();
+		for (unsigned int i = 0; i < fleet.size(); ++i) {
+			fleet[i].brd = &brd;		// Connection of ship and board
+			fleet[i].id = brd.add_ship(cells[i]);
+		}
+		update_area();
 	}
 
 	// Sets c as line color for ships of fleet
@@ -295,6 +313,7 @@ namespace Graph_lib {
 		Shape::set_style(ls);		// Update line style of shape
 		for (unsigned int i = 0; i < fleet.size(); ++i)
 			fleet[i].set_style(ls);
+		update_area();
 	}
 
 	// Sets vis as visiblity for ships of fleet
@@ -311,16 +330,25 @@ namespace Graph_lib {
 		Shape::move(dx, dy);		// Update location of shape
 		for (unsigned int i = 0; i < fleet.size(); ++i)
 			fleet[i].move(dx, dy);
+		area.x += dx;
+		area.y += dy;
+	}
+
+	// Determines lengths of ships in order of fleet (largest first)
+	std::vector<unsigned int> Fleet::lengths() const
+	{
+		std::vector<unsigned int> lens;
+		for (unsigned int i = 0; i < fleet.size(); ++i)
+			lens.push_back(static_cast<unsigned int>(fleet[i].ship_kind()));
+		return lens;
 	}
 
-	// Determines either all ships of fleet are sunken or not
-	bool Fleet::is_sunk() const
+	// Determines box of all ships of fleet
+	void Fleet::update_area()
 	{
-		// Search for any not sunken ship in fleet
+		area = Box{};
 		for (unsigned int i = 0; i < fleet.size(); ++i)
-			if (!fleet[i].is_sunk())
-				return false;
-		return true;
+			area |= fleet[i].bounds();
 	}
 
 	//------------------------------------------------------------------------------
@@ -1,5 +1,7 @@
 #pragma once
 #include "GraphicsLib/Graph.h"
+#include "GameEngine/Board.h"
+#include "GameEngine/Placement.h"
 
 //------------------------------------------------------------------------------
 
@@ -21,6 +23,9 @@ namespace Graph_lib {
 		void set_color(Color c);
 		void set_visibility(Color::Transparency vis);
 
+		// Access to parameters (reading)
+		Box bounds() const { return Grid::bounds() | lab.bounds(); }
+
 	private:
 		Marks lab;		// Label (marks)
 	};
@@ -30,25 +35,20 @@ namespace Graph_lib {
 	// Invariant: cell_w >= 0, cell_h >= 0
 	class Ship_cell : public Rectangle {
 	public:
-		friend class Ship;
-		enum class State {
-			miss, hit
-		};
+		using State = Game_engine::Shot_result;		// Results of shot at cell
 
-		// Constructs ship cell with top-left angle at xy, of
-		// size cell_w * cell_h, with miss state by default
+		// Constructs ship cell with top-left angle at xy, of size cell_w * cell_h
 		Ship_cell(Point xy, unsigned int cell_w, unsigned int cell_h)
-			: Rectangle{ xy, cell_w, cell_h }, state{ State::miss } {}
-
-	protected:
-		State state;
+			: Rectangle{ xy, cell_w, cell_h } {}
 	};
 
 	//------------------------------------------------------------------------------
 
 	// Invariant: cell_w >= 0, cell_h >= 0
+	// Note: state of cells is kept by board of fleet which ship belongs to
 	class Ship : public Shape {
 	public:
+		friend class Fleet;
 		enum class Kind {		// Kinds of shape and their length in cells
 			Torpedo_boat = 1, Destroyer = 2, Cruiser = 3, Battleship = 4
 		};
@@ -57,14 +57,12 @@ namespace Graph_lib {
 		};
 
 		// Construction
-		Ship(Point xy, unsigned int cell_w, unsigned int cell_h, Kind k, Orientation o);
+		Ship(Point xy, unsigned int cell_w, unsigned int cell_h, Kind k, Orientation o, Arena* a = nullptr);
 
 		// Drawing of shape
 		void draw_lines() const;
 
 		// Access to parametrs (writing)
-		Ship_cell::State shot(Point xy);
-		void restore();
 		void rotate();
 		void set_color(Color c);
 		void set_fill_color(Color c);
@@ -79,26 +77,36 @@ namespace Graph_lib {
 		unsigned int cell_width() const { return cells.front().width(); }
 		unsigned int cell_height() const { return cells.front().height(); }
 		const Ship_cell& operator[](unsigned int i) const { return cells[i]; }
+		Box bounds() const { return area; }
 
 	private:
 		Vector_ref<Ship_cell> cells;
 		Kind kind;
 		Orientation orient;
+		const Game_engine::Board* brd;	// Board which keeps state of cells
+		unsigned int id;				// Id of ship in board
+		Box area;						// Box of all cells (kept on rotate, set_style and move)
+
+		// Helper functions
+		void update_area();
 	};
 
 	//------------------------------------------------------------------------------
 
-	// Invariant: w >= num_of_ships * cell_w, h >= num_of_ships * cell_h, cell_w >= 0, cell_h >= 0
+	// Invariant: w >= num_of_ships * cell_w, h >= num_of_ships * cell_h, cell_w >= 0, cell_h >= 0,
+	// (w / cell_w) * (h / cell_h) <= Bitboard::capacity
 	class Fleet : public Shape {
 	public:
 		// Construction
-		Fleet(Point xy, unsigned int ww, unsigned int hh, unsigned int cell_w, unsigned int cell_h);
+		Fleet(Point xy, unsigned int ww, unsigned int hh, unsigned int cell_w, unsigned int cell_h, Arena* a = nullptr);
 
 		// Drawing of shape
 		void draw_lines() const;
 
 		// Access to parameters (writing)
 		void random_location();
+		unsigned long long random_location(Game_engine::Placement::Engine& ran);
+		void update_board();
 		Ship_cell::State shot(Point xy);
 		void restore();
 		void set_color(Color c);
@@ -109,17 +117,31 @@ namespace Graph_lib {
 		Ship& operator[](unsigned int i) { return fleet[i]; }
 
 		// Access to parameters (reading)
-		bool is_sunk() const;
+		bool is_sunk() const { return brd.is_sunk(); }
 		unsigned int frame_width() const { return w; }
 		unsigned int frame_height() const { return h; }
 		unsigned int number_of_ships() const { return fleet.size(); }
+		std::vector<unsigned int> lengths() const;
 		const Ship& operator[](unsigned int i) const { return fleet[i]; }
+		const Game_engine::Board& board() const { return brd; }
+		Box bounds() const { return area; }
 
 	private:
 		Vector_ref<Ship> fleet;
+		mutable std::vector<const Rectangle*> batch;	// Order of drawing cells (kept between drawings)
 		unsigned int w, h;			// Size of frame
+		Game_engine::Board brd;		// State of frame's cells
+		Game_engine::Placement plc;	// Legal positions of ships in frame
+		Box area;					// Box of all ships (kept on location, update_board, set_style and move)
+
+		// Helper functions
+		void update_area();
 	};
 
+	// Helper functions
+	bool is_overlap(const Ship& ship1, const Ship& ship2);
+	void move_to(Ship& ship, Point xy);
+
 	//------------------------------------------------------------------------------
 
 }
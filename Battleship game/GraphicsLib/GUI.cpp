@@ -8,13 +8,31 @@ namespace Graph_lib {
 
 	//------------------------------------------------------------------------------
 
+	// Connects FLTK's widget with callback function of widget and with win as its owner
+	void Widget::connect(Window& win)
+	{
+		if (do_at != nullptr)		// Handle of callback with payload
+			pw->callback(dispatch, this);
+		else
+			pw->callback(reinterpret_cast<Fl_Callback*>(do_it), &win);
+		own = &win;		// Connection with window
+	}
+
+	// Calls callback function of widget w with FLTK's widget pw, owner and payload of w
+	void Widget::dispatch(Fl_Widget* pw, void* w)
+	{
+		Widget& wid = reference_to<Widget>(w);
+		wid.do_at(pw, wid.own, wid.payload);
+	}
+
+	//------------------------------------------------------------------------------
+
 	// Attaches button to win
 	void Button::attach(Graph_lib::Window& win)
 	{
 		// Construction of FLTK's widget
 		pw = new Fl_Button{ loc.x, loc.y, static_cast<int>(width), static_cast<int>(height), label.c_str() };
-		pw->callback(reinterpret_cast<Fl_Callback*>(do_it), &win);
-		own = &win;		// Connection with window
+		connect(win);		// Connection with window
 	}
 
 	//------------------------------------------------------------------------------
@@ -158,16 +176,111 @@ namespace Graph_lib {
 	//------------------------------------------------------------------------------
 
 	// Constructs group with top-left angle at xy, of h_num * v_num buttons, with size of each
-	// button equal to but_w * but_h, labeled with lab, and cb as callback function for buttons
-	Group::Group(Point xy, unsigned int but_w, unsigned int but_h,
-		unsigned int h_num, unsigned int v_num, const std::string& lab, Callback cb)
-		: Widget{ xy, but_w, but_h, lab, cb }, selection{}
+	// button equal to but_w * but_h, labeled with lab, and cb as callback function for buttons;
+	// buttons are owned by a (if not null)
+	Group::Group(Point xy, unsigned int but_w, unsigned int but_h, unsigned int h_num,
+		unsigned int v_num, const std::string& lab, Callback cb, Arena* a)
+		: Widget{ xy, but_w, but_h, lab, cb }, selection{ a }
+	{
+		// Fill of grid
+		for (unsigned int h_sz = 0; h_sz < h_num; ++h_sz)          // Horizontal line
+			for (unsigned int v_sz = 0; v_sz < v_num; ++v_sz)      // Vertical line
+				selection.make_back(Point{ xy.x + static_cast<int>(but_w * h_sz),
+					xy.y + static_cast<int>(but_h * v_sz) }, but_w, but_h, "", cb);
+	}
+
+	// Constructs group with top-left angle at xy, of h_num * v_num buttons, with size of each
+	// button equal to but_w * but_h, labeled with lab, and cb as callback function for buttons,
+	// which receives index of pressed button; buttons are owned by a (if not null)
+	Group::Group(Point xy, unsigned int but_w, unsigned int but_h, unsigned int h_num,
+		unsigned int v_num, const std::string& lab, Indexed_callback cb, Arena* a)
+		: Widget{ xy, but_w, but_h, lab, cb, 0 }, selection{ a }
 	{
 		// Fill of grid
 		for (unsigned int h_sz = 0; h_sz < h_num; ++h_sz)          // Horizontal line
 			for (unsigned int v_sz = 0; v_sz < v_num; ++v_sz)      // Vertical line
-				selection.push_back(new Button{ Point{ xy.x + static_cast<int>(but_w * h_sz),
-					xy.y + static_cast<int>(but_h * v_sz) }, but_w, but_h, "", cb });
+				selection.make_back(Point{ xy.x + static_cast<int>(but_w * h_sz),
+					xy.y + static_cast<int>(but_h * v_sz) }, but_w, but_h, "", cb, selection.size());
+	}
+
+	//------------------------------------------------------------------------------
+
+	// FLTK's widget of button matrix; finds pressed button by location of mouse
+	class Fl_Button_matrix : public Fl_Widget {
+	public:
+		// Constructs widget covering all buttons of mat
+		Fl_Button_matrix(Button_matrix& mat)
+			: Fl_Widget{ mat.loc.x, mat.loc.y, static_cast<int>(mat.width), static_cast<int>(mat.height),
+			mat.label.c_str() }, matrix{ mat }, pressed{ mat.size() } { box(FL_NO_BOX); }
+
+		// Drawing of widget
+		void draw() { }		// Buttons are covered by shapes of window
+
+		// Handling of events; calls callback when active button is pressed and released
+		int handle(int event)
+		{
+			switch (event) {
+			case FL_PUSH:
+				pressed = matrix.index(Point{ Fl::event_x(), Fl::event_y() });
+				return pressed < matrix.size() && matrix.active(pressed);
+			case FL_RELEASE:
+			{
+				const unsigned int i = matrix.index(Point{ Fl::event_x(), Fl::event_y() });
+				if (i == pressed && i < matrix.size() && matrix.active(i)) {	// Released on pressed button
+					matrix.last = matrix.payload = i;
+					do_callback();
+				}
+				pressed = matrix.size();
+				return 1;
+			}
+			default:
+				return Fl_Widget::handle(event);
+			}
+		}
+
+	private:
+		Button_matrix& matrix;
+		unsigned int pressed;		// Button under mouse at pushing (size of matrix for none)
+	};
+
+	// Constructs matrix with top-left angle at xy, of h_num * v_num buttons, with size of each
+	// button equal to but_w * but_h, labeled with lab, and cb as callback function for buttons
+	Button_matrix::Button_matrix(Point xy, unsigned int bw, unsigned int bh,
+		unsigned int h, unsigned int v, const std::string& lab, Callback cb)
+		: Widget{ xy, bw * h, bh * v, lab, cb }, but_w{ bw }, but_h{ bh }, h_num{ h }, v_num{ v },
+		act(h * v, true), last{ 0 }
+	{
+		if (but_w == 0 || but_h == 0)		// Handle of empty buttons
+			throw std::invalid_argument("Bad Button_matrix: non-positive size of button");
+	}
+
+	// Constructs matrix with top-left angle at xy, of h_num * v_num buttons, with size of each
+	// button equal to but_w * but_h, labeled with lab, and cb as callback function for buttons,
+	// which receives index of pressed button
+	Button_matrix::Button_matrix(Point xy, unsigned int bw, unsigned int bh,
+		unsigned int h, unsigned int v, const std::string& lab, Indexed_callback cb)
+		: Widget{ xy, bw * h, bh * v, lab, cb, 0 }, but_w{ bw }, but_h{ bh }, h_num{ h }, v_num{ v },
+		act(h * v, true), last{ 0 }
+	{
+		if (but_w == 0 || but_h == 0)		// Handle of empty buttons
+			throw std::invalid_argument("Bad Button_matrix: non-positive size of button");
+	}
+
+	// Finds index of button at xy; size of matrix if there's no button at xy
+	unsigned int Button_matrix::index(Point xy) const
+	{
+		if (xy.x < loc.x || xy.y < loc.y)		// Handle of points before matrix
+			return size();
+		const unsigned int col = (xy.x - loc.x) / but_w, row = (xy.y - loc.y) / but_h;
+		return col < h_num && row < v_num ? col * v_num + row : size();
+	}
+
+	// Attaches button matrix to win
+	void Button_matrix::attach(Window& win)
+	{
+		// Construction of FLTK's widget
+		pw = new Fl_Button_matrix{ *this };
+		connect(win);		// Connection with window
 	}
 
 	//------------------------------------------------------------------------------
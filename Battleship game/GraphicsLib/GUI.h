@@ -22,6 +22,8 @@ namespace Graph_lib {
     // FLTK's required function type for all callback functions
     typedef void* Address;
     typedef void(*Callback)(Address, Address);
+    // Callback function, which also receives payload of widget (e.g., index of button)
+    typedef void(*Indexed_callback)(Address, Address, unsigned int);
 
     //------------------------------------------------------------------------------
 
@@ -41,7 +43,13 @@ namespace Graph_lib {
     public:
         // Constructs widget with top-left angle at xy, of size w * h, labeled lab, and cb as callback function
         Widget(Point xy, unsigned int w, unsigned int h, const std::string& lab, Callback cb)
-            : loc{ xy }, width{ w }, height{ h }, label{ lab }, do_it{ cb }, pw{ nullptr }, own{ nullptr } {}
+            : loc{ xy }, width{ w }, height{ h }, label{ lab }, do_it{ cb }, do_at{ nullptr }, payload{ 0 },
+            pw{ nullptr }, own{ nullptr } {}
+        // Constructs widget with top-left angle at xy, of size w * h, labeled lab, and
+        // cb as callback function, which receives i as payload
+        Widget(Point xy, unsigned int w, unsigned int h, const std::string& lab, Indexed_callback cb, unsigned int i)
+            : loc{ xy }, width{ w }, height{ h }, label{ lab }, do_it{ nullptr }, do_at{ cb }, payload{ i },
+            pw{ nullptr }, own{ nullptr } {}
 
         // Destructs widget
         virtual ~Widget() { }
@@ -70,10 +78,19 @@ namespace Graph_lib {
         unsigned int height;
         std::string label;
         Callback do_it;         // Callback function
+        Indexed_callback do_at; // Callback function with payload
+        unsigned int payload;   // Payload of callback function
 
     protected:
+        // Connection of FLTK's widget with callback function and win
+        void connect(Window& win);
+
         Window* own;        // Address of widget's owner
         Fl_Widget* pw;      // Address of FLTK's widget
+
+    private:
+        // Helper function
+        static void dispatch(Fl_Widget* pw, void* w);    // Calls do_at of widget w with its payload
     };
 
     //------------------------------------------------------------------------------
@@ -85,6 +102,10 @@ namespace Graph_lib {
         // w * h, labeled lab, and cb as callback function
         Button(Point xy, unsigned int w, unsigned int h, const std::string& lab, Callback cb)
             : Widget{ xy, w, h, lab, cb } {}
+        // Constructs button with top-left angle at xy, of size w * h,
+        // labeled lab, and cb as callback function, which receives i
+        Button(Point xy, unsigned int w, unsigned int h, const std::string& lab, Indexed_callback cb, unsigned int i)
+            : Widget{ xy, w, h, lab, cb, i } {}
 
         // Connection with window
         void attach(Window&);
@@ -205,8 +226,10 @@ namespace Graph_lib {
     class Group : public Widget {
     public:
         // Construction
-        Group(Point xy, unsigned int but_w, unsigned int but_h,
-            unsigned int h_num, unsigned int v_num, const std::string& lab, Callback cb);
+        Group(Point xy, unsigned int but_w, unsigned int but_h, unsigned int h_num,
+            unsigned int v_num, const std::string& lab, Callback cb, Arena* a = nullptr);
+        Group(Point xy, unsigned int but_w, unsigned int but_h, unsigned int h_num,
+            unsigned int v_num, const std::string& lab, Indexed_callback cb, Arena* a = nullptr);
 
         // Access to parameters (writing)
         // Moves all buttons of group dx by x-coordinate and dy by y-coordinate
@@ -259,6 +282,45 @@ namespace Graph_lib {
 
     //------------------------------------------------------------------------------
 
+    class Fl_Button_matrix;     // "Forward declare" of FLTK's widget of button matrix
+
+    // Invariant: but_w > 0, but_h > 0, h_num >= 0, v_num >= 0
+    // Note: buttons are numbered by columns, i.e., button i is at column i / v_num and row i % v_num
+    class Button_matrix : public Widget {   // Matrix of buttons handled by single widget
+    public:
+        friend class Fl_Button_matrix;
+
+        // Construction
+        Button_matrix(Point xy, unsigned int but_w, unsigned int but_h,
+            unsigned int h_num, unsigned int v_num, const std::string& lab, Callback cb);
+        Button_matrix(Point xy, unsigned int but_w, unsigned int but_h,
+            unsigned int h_num, unsigned int v_num, const std::string& lab, Indexed_callback cb);
+
+        // Access to parameters (writing)
+        void activate() { std::fill(act.begin(), act.end(), true); }        // Activate all buttons
+        void deactivate() { std::fill(act.begin(), act.end(), false); }    // Deactivate all buttons
+        void activate(unsigned int i) { act[i] = true; }
+        void deactivate(unsigned int i) { act[i] = false; }
+
+        // Access to parameters (reading)
+        using Widget::active;
+        bool active(unsigned int i) const { return act[i]; }
+        unsigned int chosen() const { return last; }       // Last pressed button
+        unsigned int size() const { return act.size(); }
+        unsigned int index(Point xy) const;
+
+        // Connection with window
+        void attach(Window& win);
+
+    private:
+        unsigned int but_w, but_h;      // Size of each button
+        unsigned int h_num, v_num;      // Number of columns and rows
+        std::vector<bool> act;          // Activity of buttons
+        unsigned int last;              // Last pressed button
+    };
+
+    //------------------------------------------------------------------------------
+
 }   // of namespace Graph_lib
 
 #endif // GUI_GUARD
@@ -2,6 +2,10 @@
 
 #include <fstream>
 #include <map>
+#include <set>
+#include <cstdlib>
+#include <iterator>
+#include <cstdint>
 #include <algorithm>
 #include "Graph.h"
 
@@ -11,26 +15,75 @@ namespace Graph_lib {
 
 	//------------------------------------------------------------------------------
 
+	// Destroys all objects of arena in reverse order of their creation and frees its blocks
+	void Arena::clear()
+	{
+		for (auto i = dtors.rbegin(); i != dtors.rend(); ++i)
+			i->destroy(i->obj);
+		dtors.clear();
+		blocks.clear();
+		cur = nullptr;
+		left = 0;
+	}
+
+	// Takes sz bytes, aligned with align, from last block; starts new block if needed
+	void* Arena::allocate(size_type sz, size_type align)
+	{
+		size_type pad = (align - reinterpret_cast<std::uintptr_t>(cur) % align) % align;	// Bytes to align
+		if (cur == nullptr || pad + sz > left) {		// Handle of full block
+			const size_type n = std::max(blk_sz, sz + align);
+			blocks.emplace_back(new char[n]);
+			cur = blocks.back().get();
+			left = n;
+			pad = (align - reinterpret_cast<std::uintptr_t>(cur) % align) % align;
+		}
+		void* mem = cur + pad;
+		cur += pad + sz;
+		left -= pad + sz;
+		return mem;
+	}
+
+	//------------------------------------------------------------------------------
+
 	// Connects points of shape with lines
 	void Shape::draw_lines() const
 	{
 		// Connect points with lines
 		if (color().visibility())		// Draw only if color is visible
 			for (unsigned int i = 1; i < points.size(); ++i)
-				fl_line(points[i - 1].x, points[i - 1].y, points[i].x, points[i].y);
+				painter().line(points[i - 1].x, points[i - 1].y, points[i].x, points[i].y);
 	}
 
-	// Draws lines of shape, sets color of lines and style of lines
+	// Draws lines of shape, sets color of lines and style of lines;
+	// shapes outside of area being redrawn (damaged area) are skipped
 	void Shape::draw() const
 	{
-		const Fl_Color oldc = fl_color();	// Old color
+		Painter& p = painter();
+		const Box b = bounds();
+		if (!p.is_visible(b.x, b.y, b.w, b.h)) return;	// Handle of undamaged shape
+		const Fl_Color oldc = p.color();	// Old color
 		// Set color and style of lines
-		fl_color(lcolor.as_int());
-		fl_line_style(lstyle.style(), lstyle.width());
+		p.set_color(lcolor.as_int());
+		p.set_style(lstyle.style(), lstyle.width());
 		draw_lines();
 		// Reset color and style of lines
-		fl_color(oldc);
-		fl_line_style(0);		// Default style of lines
+		p.set_color(oldc);
+		p.set_style(0, 0);		// Default style of lines
+	}
+
+	// Sets p as point i of shape; box of points is recomputed only if point i was on its border
+	void Shape::set_point(unsigned int i, Point p)
+	{
+		const Point old = points[i];
+		points[i] = p;
+		if (old.x != ext.x && old.x != ext.x + static_cast<int>(ext.w) - 1
+			&& old.y != ext.y && old.y != ext.y + static_cast<int>(ext.h) - 1) {
+			ext |= Box{ p, 1, 1 };		// Box can only grow
+			return;
+		}
+		ext = Box{};
+		for (unsigned int j = 0; j < points.size(); ++j)
+			ext |= Box{ points[j], 1, 1 };
 	}
 
 	//------------------------------------------------------------------------------
@@ -52,21 +105,186 @@ namespace Graph_lib {
 			((x2 - x1) * (y1 - y3) - (y2 - y1) * (x1 - x3)) / denom);
 	}
 
-	// Determines either two lines (p1, p2) and (p3, p4) intersect each other;
-	// Returns true and intersection point if lines are intersected
+	// Determines on which side of line (p1, p2) lies p3: left if > 0, right if < 0, on line if 0
+	// Note: result is exact while coordinates lie within [-2^30, 2^30]
+	inline long long orientation(Point p1, Point p2, Point p3)
+	{
+		return (static_cast<long long>(p2.x) - p1.x) * (static_cast<long long>(p3.y) - p1.y) -
+			(static_cast<long long>(p2.y) - p1.y) * (static_cast<long long>(p3.x) - p1.x);
+	}
+
+	// Determines either p lies in box with opposite angles p1 and p2
+	inline bool in_range(Point p1, Point p2, Point p)
+	{
+		return std::min(p1.x, p2.x) <= p.x && p.x <= std::max(p1.x, p2.x) &&
+			std::min(p1.y, p2.y) <= p.y && p.y <= std::max(p1.y, p2.y);
+	}
+
+	// Determines either p1 is met earlier than p2 by sweep line (ordered by x, then by y)
+	inline bool sweep_less(Point p1, Point p2) { return p1.x < p2.x || (p1.x == p2.x && p1.y < p2.y); }
+
+	// Determines either line segments (p1, p2) and (p3, p4) have common point; uses integers only
+	bool segment_intersect(Point p1, Point p2, Point p3, Point p4)
+	{
+		const long long o1 = orientation(p1, p2, p3), o2 = orientation(p1, p2, p4);
+		const long long o3 = orientation(p3, p4, p1), o4 = orientation(p3, p4, p2);
+		if (((o1 > 0 && o2 < 0) || (o1 < 0 && o2 > 0)) && ((o3 > 0 && o4 < 0) || (o3 < 0 && o4 > 0)))
+			return true;		// Segments cross each other
+		// Handle of touching and overlapping segments
+		return (!o1 && in_range(p1, p2, p3)) || (!o2 && in_range(p1, p2, p4)) ||
+			(!o3 && in_range(p3, p4, p1)) || (!o4 && in_range(p3, p4, p2));
+	}
+
+	// Determines either two line segments (p1, p2) and (p3, p4) intersect each other;
+	// Returns true and intersection point if segments are intersected
 	bool line_segment_intersect(Point p1, Point p2, Point p3, Point p4, Point& intersection)
 	{
-		static constexpr double r1 = 0.0, r2 = 1.0;		// Range for determining equation
+		if (!segment_intersect(p1, p2, p3, p4)) return false;
 		bool parallel;									// Parallelism of lines
 		// Determine unknown equations for lines
 		std::pair<double, double> u = line_intersect(p1, p2, p3, p4, parallel);
-		if (parallel || u.first < r1 || u.first > r2 || u.second < r1 || u.second > r2) return false;
+		if (parallel) {		// Handle of overlapping segments (end of one lies on another)
+			intersection = in_range(p3, p4, p1) ? p1 : in_range(p3, p4, p2) ? p2 : p3;
+			return true;
+		}
 		// Determine intersection point
 		intersection.x = p1.x + static_cast<int>(u.first * (double(p2.x) - double(p1.x)));
 		intersection.y = p1.y + static_cast<int>(u.first * (double(p2.y) - double(p1.y)));
 		return true;
 	}
 
+	//------------------------------------------------------------------------------
+
+	// Line segment of sequence of points; a is met by sweep line before b
+	struct Sweep_segment {
+		Point a, b;
+	};
+
+	// Order of segments crossed by sweep line (from bottom to top)
+	// Note: order is consistent while segments in sweep line don't intersect each other
+	struct Sweep_order {
+		const std::vector<Sweep_segment>* segs;
+
+		bool operator()(unsigned int i, unsigned int j) const
+		{
+			if (i == j) return false;
+			const Sweep_segment& s = (*segs)[i];
+			const Sweep_segment& t = (*segs)[j];
+			long long o;	// Side of line of older segment, where newer segment lies
+			if (sweep_less(t.a, s.a)) {
+				if (!(o = orientation(t.a, t.b, s.a))) o = orientation(t.a, t.b, s.b);
+				return o ? o < 0 : i < j;
+			}
+			if (!(o = orientation(s.a, s.b, t.a))) o = orientation(s.a, s.b, t.b);
+			return o ? o > 0 : i < j;
+		}
+	};
+
+	// Determines either non-adjacent lines of sequence ps intersect each other, using sweep line;
+	// closed sequence also has line from last point to first one; O(n * log(n)) time
+	// Returns true and intersection point if lines are intersected
+	// Note: adjacent lines aren't checked, they must not lie in a straight line
+	bool sequence_intersect(const std::vector<Point>& ps, bool closed, Point& intersection)
+	{
+		const unsigned int n = ps.size();
+		const unsigned int m = closed ? n : (n ? n - 1 : 0);	// Number of lines
+		if (m < 2) return false;
+		std::vector<Sweep_segment> segs(m);
+		std::vector<std::pair<Point, unsigned int>> events;	// Ends of lines: 2 * i is beginning of line i
+		events.reserve(2 * m);
+		for (unsigned int i = 0; i < m; ++i) {
+			const Point p1 = ps[i], p2 = ps[i + 1 < n ? i + 1 : 0];
+			segs[i] = sweep_less(p1, p2) ? Sweep_segment{ p1, p2 } : Sweep_segment{ p2, p1 };
+			events.push_back(std::make_pair(segs[i].a, 2 * i));
+			events.push_back(std::make_pair(segs[i].b, 2 * i + 1));
+		}
+		// At the same point, ends of lines are handled before beginnings
+		std::sort(events.begin(), events.end(), [](const std::pair<Point, unsigned int>& e1,
+			const std::pair<Point, unsigned int>& e2) {
+			if (e1.first == e2.first) return (e1.second & 1) > (e2.second & 1);
+			return sweep_less(e1.first, e2.first);
+		});
+		auto vertex = [&](const std::pair<Point, unsigned int>& e) {	// Index of point of event
+			const unsigned int i = e.second / 2;
+			return ps[i] == e.first ? i : (i + 1 < n ? i + 1 : 0);
+		};
+		auto check = [&](unsigned int i, unsigned int j) {		// Check non-adjacent lines
+			if (i > j) std::swap(i, j);
+			if (j == i + 1 || (closed && !i && j == m - 1)) return false;
+			return line_segment_intersect(segs[i].a, segs[i].b, segs[j].a, segs[j].b, intersection);
+		};
+		std::set<unsigned int, Sweep_order> line{ Sweep_order{ &segs } };	// Lines crossed by sweep line
+		std::vector<std::set<unsigned int, Sweep_order>::iterator> pos(m);	// Positions in sweep line
+		for (unsigned int k = 0; k < events.size(); ++k) {
+			// Handle of equal points of sequence
+			if (k && events[k].first == events[k - 1].first && vertex(events[k]) != vertex(events[k - 1])) {
+				intersection = events[k].first;
+				return true;
+			}
+			const unsigned int i = events[k].second / 2;
+			if (events[k].second & 1) {		// End of line: its neighbours become adjacent
+				const auto next = std::next(pos[i]);
+				if (pos[i] != line.begin() && next != line.end() && check(*std::prev(pos[i]), *next)) return true;
+				line.erase(pos[i]);
+			}
+			else {							// Beginning of line: check it with its neighbours
+				pos[i] = line.insert(i).first;
+				const auto next = std::next(pos[i]);
+				if (next != line.end() && check(i, *next)) return true;
+				if (pos[i] != line.begin() && check(*std::prev(pos[i]), i)) return true;
+			}
+		}
+		return false;
+	}
+
+	//------------------------------------------------------------------------------
+
+	// Checks that points p1, p2 and p3 can be consecutive points of polygon
+	void check_corner(Point p1, Point p2, Point p3)
+	{
+		if (p2 == p3)						// Handle of equal points (new and previous)
+			throw std::invalid_argument("Bad Polygon: new point equal to previous point");
+		if (!orientation(p1, p2, p3))		// Handle of parallel lines (new and previous)
+			throw std::invalid_argument("Bad Polygon: two points lie in a straight line");
+	}
+
+	// Constructs polygon with points from ps; whole polygon (with line from last point to first one)
+	// is checked by sweep line
+	Polygon::Polygon(const std::vector<Point>& ps)
+	{
+		const unsigned int n = ps.size();
+		const bool closed = n > 2;			// Last point is connected to first one
+		// Error handling
+		for (unsigned int i = 1; i < n; ++i) {
+			if (ps[i] == ps[i - 1])			// Handle of equal points (new and previous)
+				throw std::invalid_argument("Bad Polygon: new point equal to previous point");
+			if (i > 1) check_corner(ps[i - 2], ps[i - 1], ps[i]);
+		}
+		if (closed) {
+			check_corner(ps[n - 2], ps[n - 1], ps[0]);
+			check_corner(ps[n - 1], ps[0], ps[1]);
+		}
+		Point intersection{ 0, 0 };
+		if (sequence_intersect(ps, closed, intersection))	// Handle of intersected lines
+			throw std::invalid_argument("Bad Polygon: intersection of lines in " + to_string(intersection));
+		for (unsigned int i = 0; i < n; ++i) {
+			Closed_polyline::add(ps[i]);
+			if (i) add_edge(i - 1);
+		}
+	}
+
+	// Segment tree over x: node of level k with number j holds lines covering x from [j * 2^k, (j + 1) * 2^k)
+	constexpr unsigned int span_levels = 33;		// Levels of tree over 2^32 values of x
+
+	// Maps x relative to first point of polygon into [0, 2^32)
+	inline unsigned long long span_x(long long x) { return static_cast<unsigned long long>(x + (1LL << 31)); }
+
+	// Determines key of node of level k with number j
+	inline unsigned long long span_node(unsigned int k, unsigned long long j)
+	{
+		return (static_cast<unsigned long long>(k) << span_levels) | j;	// j < 2^32 <= 2^span_levels
+	}
+
 	// Adds p to all points
 	void Polygon::add(Point p)
 	{
@@ -75,18 +293,44 @@ namespace Graph_lib {
 		if (num && p == point(num - 1))		// Handle of equal points (new and previous)
 			throw std::invalid_argument("Bad Polygon: new point equal to previous point");
 		if (num > 1) {
-			bool parallel;		// Parallelism of lines
-			line_intersect(point(num - 1), p, point(num - 2), point(num - 1), parallel);
-			if (parallel)					// Handle of parallel lines (new and previous)
-				throw std::invalid_argument("Bad Polygon: two points lie in a straight line");
-			for (unsigned int i = 1; i < num - 1; ++i) {
+			check_corner(point(num - 2), point(num - 1), p);
+			const Point q = point(num - 1);
+			auto check = [&](unsigned int i) {		// Check line i with new line (adjacent line isn't checked)
 				Point intersection{ 0, 0 };
-				// Handle of intersected lines (new and all others)
-				if (line_segment_intersect(point(num - 1), p, point(i - 1), point(i), intersection))
+				if (i + 2 < num && line_segment_intersect(q, p, point(i), point(i + 1), intersection))
 					throw std::invalid_argument("Bad Polygon: intersection of lines in " + to_string(intersection));
+			};
+			// Only lines overlapping new line by x can reach it: either lines crossing its left end
+			// or lines beginning (in order of sweep line) between its ends
+			const long long x1 = std::min(q.x, p.x) - static_cast<long long>(point(0).x);
+			const long long x2 = std::max(q.x, p.x) - static_cast<long long>(point(0).x);
+			const unsigned long long u = span_x(x1);
+			for (unsigned int k = 0; k < span_levels; ++k) {		// Nodes of tree on way from leaf u to root
+				const auto node = spans.find(span_node(k, u >> k));
+				if (node != spans.end())
+					for (unsigned int i : node->second) check(i);
 			}
+			for (auto it = edges.upper_bound(x1); it != edges.end() && it->first <= x2; ++it)
+				check(it->second);
 		}
 		Closed_polyline::add(p);
+		if (num) add_edge(num - 1);
+	}
+
+	// Adds line from point i to next one into indices of lines
+	void Polygon::add_edge(unsigned int i)
+	{
+		const Point p1 = point(i), p2 = point(i + 1);
+		const long long x1 = std::min(p1.x, p2.x) - static_cast<long long>(point(0).x);
+		const long long x2 = std::max(p1.x, p2.x) - static_cast<long long>(point(0).x);
+		edges.insert(std::make_pair(x1, i));
+		// Cover [x1, x2] with largest nodes of tree; at most 2 nodes per level
+		for (unsigned long long l = span_x(x1), r = span_x(x2) + 1; l < r; ) {
+			unsigned int k = 0;
+			while (k + 1 < span_levels && !(l & (1ULL << k)) && l + (2ULL << k) <= r) ++k;
+			spans[span_node(k, l >> k)].push_back(i);
+			l += 1ULL << k;
+		}
 	}
 
 	// Connects points of polygon with lines, fills it with color
@@ -106,13 +350,14 @@ namespace Graph_lib {
 	{
 		// Fill shape with color
 		if (fill_color().visibility()) {		// Fill only if fill color is visible
-			fl_color(fill_color().as_int());	// Set fill color
+			painter().set_color(fill_color().as_int());	// Set fill color
 			// Map points to fill shape
-			fl_begin_complex_polygon();
+			std::vector<Point> ps;
+			ps.reserve(number_of_points());
 			for (unsigned int i = 0; i < number_of_points(); ++i)
-				fl_vertex(point(i).x, point(i).y);
-			fl_end_complex_polygon();
-			fl_color(color().as_int());			// Reset fill color
+				ps.push_back(point(i));
+			painter().polygon(ps);
+			painter().set_color(color().as_int());		// Reset fill color
 		}
 		Shape::draw_lines();		// Connect points with lines
 	}
@@ -126,7 +371,7 @@ namespace Graph_lib {
 		// Draw closing line
 		const unsigned int num = number_of_points();
 		if (color().visibility() && num > 1)	// Draw only if color is visible
-			fl_line(point(num - 1).x, point(num - 1).y, point(0).x, point(0).y);
+			painter().line(point(num - 1).x, point(num - 1).y, point(0).x, point(0).y);
 	}
 
 	//------------------------------------------------------------------------------
@@ -138,6 +383,8 @@ namespace Graph_lib {
 			points[i].x += dx;		// Move by x-coordinate
 			points[i].y += dy;		// Move by y-coordinate
 		}
+		ext.x += dx;
+		ext.y += dy;
 	}
 
 	//------------------------------------------------------------------------------
@@ -148,7 +395,7 @@ namespace Graph_lib {
 		// Connect pairs of points with lines
 		if (color().visibility())		// Draw only if color is visible
 			for (unsigned int i = 1; i < number_of_points(); i += 2)
-				fl_line(point(i - 1).x, point(i - 1).y, point(i).x, point(i).y);
+				painter().line(point(i - 1).x, point(i - 1).y, point(i).x, point(i).y);
 	}
 
 	//------------------------------------------------------------------------------
@@ -156,12 +403,21 @@ namespace Graph_lib {
 	// Draws label of text; note: don't try to use new line characters
 	void Text::draw_lines() const
 	{
-		const int old_fnt = fl_font();	// Old font
-		const int old_sz = fl_size();	// Old size of font
+		Painter& p = painter();
+		const int old_fnt = p.font();		// Old font
+		const int old_sz = p.font_size();	// Old size of font
 		// Draw label of text
-		fl_font(fnt.as_char(), fnt_sz);		// Set new font and font size
-		fl_draw(lab.c_str(), point(0).x, point(0).y);
-		fl_font(old_fnt, old_sz);			// Reset to old font and font size
+		p.set_font(fnt.as_char(), fnt_sz);	// Set new font and font size
+		p.text(lab, point(0).x, point(0).y);
+		p.set_font(old_fnt, old_sz);		// Reset to old font and font size
+	}
+
+	// Estimates box of label using size of font as size of each symbol
+	Box Text::bounds() const
+	{
+		const unsigned int desc = fnt_sz / 2;		// Descent of symbols below bottom line
+		return Box{ Point{ point(0).x, point(0).y - static_cast<int>(fnt_sz) },
+			fnt_sz * static_cast<unsigned int>(lab.size()), fnt_sz + desc };
 	}
 
 	//------------------------------------------------------------------------------
@@ -190,14 +446,14 @@ namespace Graph_lib {
 	{
 		// Fill shape with color
 		if (fill_color().visibility()) {		// Fill only if fill color is visible
-			fl_color(fill_color().as_int());	// Set fill color
-			fl_rectf(point(0).x, point(0).y, w, h);
-			fl_color(color().as_int());			// Reset color
+			painter().set_color(fill_color().as_int());	// Set fill color
+			painter().rectf(point(0).x, point(0).y, w, h);
+			painter().set_color(color().as_int());			// Reset color
 		}
 		// Draw lines
 		if (color().visibility()) {		// Draw only if color is visible
-			fl_color(color().as_int());
-			fl_rect(point(0).x, point(0).y, w, h);
+			painter().set_color(color().as_int());
+			painter().rect(point(0).x, point(0).y, w, h);
 		}
 	}
 
@@ -284,14 +540,14 @@ namespace Graph_lib {
 		static constexpr unsigned int beg = 0, end = 360;	// Start and end angles
 		// Fill shape with color
 		if (fill_color().visibility()) {		// Fill only if fill color is visible
-			fl_color(fill_color().as_int());	// Set fill color
-			fl_pie(point(0).x, point(0).y, r + r - 1, r + r - 1, beg, end);
-			fl_color(color().as_int());			// Reset color
+			painter().set_color(fill_color().as_int());	// Set fill color
+			painter().pie(point(0).x, point(0).y, r + r - 1, r + r - 1, beg, end);
+			painter().set_color(color().as_int());			// Reset color
 		}
 		// Draw line segments
 		if (color().visibility()) {		//  Draw only if color is visible
-			fl_color(color().as_int());
-			fl_arc(point(0).x, point(0).y, r + r, r + r, beg, end);
+			painter().set_color(color().as_int());
+			painter().arc(point(0).x, point(0).y, r + r, r + r, beg, end);
 		}
 	}
 
@@ -303,27 +559,29 @@ namespace Graph_lib {
 		static constexpr unsigned int beg = 0, end = 360;	// Start and end angles
 		// Fill shape with color
 		if (fill_color().visibility()) {		// Fill only if fill color is visible
-			fl_color(fill_color().as_int());	// Set fill color
-			fl_pie(point(0).x, point(0).y, w + w - 1, h + h - 1, beg, end);
-			fl_color(color().as_int());			// Reset color
+			painter().set_color(fill_color().as_int());	// Set fill color
+			painter().pie(point(0).x, point(0).y, w + w - 1, h + h - 1, beg, end);
+			painter().set_color(color().as_int());			// Reset color
 		}
 		// Draw line segments
 		if (color().visibility()) {		// Draw only if color is visible
-			fl_color(color().as_int());
-			fl_arc(point(0).x, point(0).y, w + w, h + h, beg, end);
+			painter().set_color(color().as_int());
+			painter().arc(point(0).x, point(0).y, w + w, h + h, beg, end);
 		}
 	}
 
 	//------------------------------------------------------------------------------
 
+	// Offsets of mark's bottom-left angle from its center
+	constexpr int mark_dx = 4;		// Offset by x-coordinate
+	constexpr int mark_dy = 4;		// Offset by y-coordinate
+
 	// Draws mark with center at xy, labeled lab
 	void draw_mark(Point xy, char lab)
 	{
-		static constexpr int dx = 4;	// Offset by x-coordinate
-		static constexpr int dy = 4;	// Offset by y-coordinate
 		std::string mark{ lab };
 		// Draw mark
-		fl_draw(mark.c_str(), xy.x - dx, xy.y + dy);
+		painter().text(mark, xy.x - mark_dx, xy.y + mark_dy);
 	}
 
 	// Connects points with lines, draws marks at each point
@@ -331,16 +589,27 @@ namespace Graph_lib {
 	{
 		Open_polyline::draw_lines();	// Connect points with lines
 		if (mark.color().visibility()) {	// Draw only if color is visible
-			const int old_fnt = fl_font();	// Old font
-			const int old_sz = fl_size();	// Old size of font
-			fl_font(mark.font().as_char(), mark.font_size());		// Set new font and font size
+			Painter& p = painter();
+			const int old_fnt = p.font();		// Old font
+			const int old_sz = p.font_size();	// Old size of font
+			p.set_font(mark.font().as_char(), mark.font_size());	// Set new font and font size
 			// Draw marks at each point
 			for (unsigned int i = 0; i < number_of_points(); ++i)
 				draw_mark(point(i), mark.label()[i % mark.label().size()]);
-			fl_font(old_fnt, old_sz);			// Reset to old font and font size
+			p.set_font(old_fnt, old_sz);		// Reset to old font and font size
 		}
 	}
 
+	// Determines box of open polyline and marks at each point
+	Box Marked_polyline::bounds() const
+	{
+		Box b = Open_polyline::bounds();
+		const unsigned int sz = mark.font_size();
+		for (unsigned int i = 0; i < number_of_points(); ++i)
+			b |= Box{ Point{ point(i).x - mark_dx, point(i).y + mark_dy - static_cast<int>(sz) }, sz, sz + sz / 2 };
+		return b;
+	}
+
 	// Sets c as line color of open polyline and marks
 	void Marked_polyline::set_color(Color c)
 	{
@@ -425,34 +694,67 @@ namespace Graph_lib {
 		// Draw label
 		if (lab.label() != "")		// Draw only if label isn't empty
 			lab.draw_lines();
-		// Draw image
-		if (w && h)		// Draw with "masking box"
-			pi->draw(point(0).x, point(0).y, w, h, cx, cy);
-		else			// Draw without "masking box"
-			pi->draw(point(0).x, point(0).y);
+		// Draw image (whole image if there's no "masking box")
+		painter().image(*pi, point(0).x, point(0).y, w, h, cx, cy);
+	}
+
+	// Determines box of image (or its "masking box") and label
+	Box Image::bounds() const
+	{
+		const Box img = w && h ? Box{ point(0), w, h } :
+			Box{ point(0), static_cast<unsigned int>(pi->w()), static_cast<unsigned int>(pi->h()) };
+		return lab.label() != "" ? img | lab.bounds() : img;
 	}
 
 	//------------------------------------------------------------------------------
 
 	// Constructs grid with top-left angle at xy, of h_num * v_num
 	// cells, and with size of each cell equal to cell_w * cell_h
-	Grid::Grid(Point xy, unsigned int cell_w, unsigned int cell_h, unsigned int h_num, unsigned int v_num)
-		: cells{}
+	Grid::Grid(Point xy, unsigned int cw, unsigned int ch, unsigned int h, unsigned int v)
+		: tl{}, fills(h * v, fill_color()), cell_w{ cw }, cell_h{ ch }, h_num{ v != 0 ? h : 0 }, v_num{ h != 0 ? v : 0 },
+		lay{ Layer::all }
 	{
 		// Fill of grid
+		tl.reserve(h_num * v_num);
 		for (unsigned int h_sz = 0; h_sz < h_num; ++h_sz)          // Horizontal line
 			for (unsigned int v_sz = 0; v_sz < v_num; ++v_sz)      // Vertical line
-				cells.push_back(new Rectangle{ Point{ xy.x + static_cast<int>(cell_w * h_sz),
-					xy.y + static_cast<int>(cell_h * v_sz) }, cell_w, cell_h });
+				tl.push_back(Point{ xy.x + static_cast<int>(cell_w * h_sz), xy.y + static_cast<int>(cell_h * v_sz) });
 		add(xy);							// Top-left angle of grid
 	}
 
-	// Draws cells and fills them with color
+	// Draws cells and fills them with color; only part of grid chosen by its layer is drawn.
+	// Cells are filled in groups of same fill color, so fill color is set once for each group
 	void Grid::draw_lines() const
 	{
-		// Draw cells of grid
-		for (unsigned int i = 0; i < cells.size(); ++i)
-			cells[i].draw();
+		// Skip cells outside of damaged area
+		order.clear();
+		for (unsigned int i = 0; i < tl.size(); ++i) {
+			const Box b = (*this)[i].bounds();
+			if (painter().is_visible(b.x, b.y, b.w, b.h)) order.push_back(i);
+		}
+		// Fill cells grouped by fill color; in fills layer, inside of thin lines only,
+		// leaving them to be drawn by lines layer (i.e., from static layer of window)
+		const bool thin = is_thin_line(*this);
+		if (lay != Layer::lines) {
+			std::sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b)
+				{ return fills[a].as_int() < fills[b].as_int(); });
+			const Color* last = nullptr;		// Last fill color
+			for (unsigned int i : order)
+				if (fills[i].visibility()) {		// Fill only if fill color is visible
+					if (last == nullptr || last->as_int() != fills[i].as_int())
+						painter().set_color(fills[i].as_int());	// Set fill color of group
+					if (lay == Layer::fills && thin)
+						painter().rectf(tl[i].x + 1, tl[i].y + 1, static_cast<int>(cell_w) - 2, static_cast<int>(cell_h) - 2);
+					else painter().rectf(tl[i].x, tl[i].y, cell_w, cell_h);
+					last = &fills[i];
+				}
+		}
+		// Draw lines of cells
+		if (color().visibility() && (lay != Layer::fills || !thin)) {	// Draw only if color is visible
+			painter().set_color(color().as_int());			// Reset color
+			for (unsigned int i : order)
+				painter().rect(tl[i].x, tl[i].y, cell_w, cell_h);
+		}
 	}
 
 	// Moves cells by dx at x-coordinate and dy at y-coordinate 
@@ -460,35 +762,18 @@ namespace Graph_lib {
 	{
 		Shape::move(dx, dy);
 		// Move cells of grid
-		for (unsigned int i = 0; i < cells.size(); ++i)
-			cells[i].move(dx, dy);
-	}
-
-	// Sets c as color of cells' lines
-	void Grid::set_color(Color c)
-	{
-		Shape::set_color(c);
-		// Set c as color of lines to cells
-		for (unsigned int i = 0; i < cells.size(); ++i)
-			cells[i].set_color(c);
+		for (auto& p : tl) {
+			p.x += dx;
+			p.y += dy;
+		}
 	}
 
 	// Sets c as fill color of cells
 	void Grid::set_fill_color(Color c)
 	{
 		Shape::set_fill_color(c);
-		// Set c as fill color to cells
-		for (unsigned int i = 0; i < cells.size(); ++i)
-			cells[i].set_fill_color(c);
-	}
-
-	// Sets ls as line style of cells' lines
-	void Grid::set_style(Line_style ls)
-	{
-		Shape::set_style(ls);
-		// Set ls as line style to cells
-		for (unsigned int i = 0; i < cells.size(); ++i)
-			cells[i].set_style(ls);
+		std::fill(fills.begin(), fills.end(), c);	// Set c as fill color to cells
+		damaged(bounds());
 	}
 
 	// Sets vis as visibility of cells
@@ -496,38 +781,68 @@ namespace Graph_lib {
 	{
 		Shape::set_visibility(vis);
 		// Set vis as visiblity to cells
-		for (unsigned int i = 0; i < cells.size(); ++i)
-			cells[i].set_visibility(vis);
+		for (auto& c : fills)
+			c.set_visibility(vis);
+		damaged(bounds());
 	}
 
-	// Determines width of grid
-	unsigned int Grid::width() const
+	// Finds number of cell at xy; size of grid if there's no cell at xy
+	unsigned int Grid::index(Point xy) const
 	{
-		// Search for cells with min and max possible x-coordinate
-		const auto minmax_x = std::minmax_element(cells.cbegin(), cells.cend(),
-			[](const Rectangle* a, const Rectangle* b) { return a->point(0).x < b->point(0).x; });
-		const auto min_x = *minmax_x.first, max_x = *minmax_x.second;
-		// Difference between min and max x-coordinates of cells, added to width of cell
-		return min_x != nullptr && max_x != nullptr ? max_x->point(0).x - min_x->point(0).x + max_x->width() : 0;
+		if (xy.x < point(0).x || xy.y < point(0).y || cell_w == 0 || cell_h == 0)	// Handle of points before grid
+			return size();
+		const unsigned int col = (xy.x - point(0).x) / cell_w, row = (xy.y - point(0).y) / cell_h;
+		return col < h_num && row < v_num ? col * v_num + row : size();
 	}
 
-	// Determines height of grid
-	unsigned int Grid::height() const
+	// Determines either lines of s are solid lines of one pixel width
+	bool is_thin_line(const Shape& s)
 	{
-		// Search for cells with min and max possible y-coordinate
-		const auto minmax_y = std::minmax_element(cells.cbegin(), cells.cend(),
-			[](const Rectangle* a, const Rectangle* b) { return a->point(0).y < b->point(0).y; });
-		const auto min_y = *minmax_y.first, max_y = *minmax_y.second;
-		// Difference between min and max x-coordinates of cells, added to width of cell
-		return min_y != nullptr && max_y != nullptr ? max_y->point(0).y - min_y->point(0).y + max_y->height() : 0;
+		return s.color().visibility() && s.style().style() == FL_SOLID && s.style().width() <= 1;
+	}
+
+	// Draws rectangles of rs as groups sharing same color and style, that is, color and style
+	// are set once for each group; all fills are drawn first, then all lines. Result is same
+	// as of drawing rectangles one by one if they don't overlap each other. Order of rs is changed
+	void draw_batch(std::vector<const Rectangle*>& rs)
+	{
+		// Skip rectangles outside of damaged area
+		rs.erase(std::remove_if(rs.begin(), rs.end(), [](const Rectangle* r)
+			{ const Box b = r->bounds(); return !painter().is_visible(b.x, b.y, b.w, b.h); }), rs.end());
+		// Fill rectangles grouped by fill color
+		std::sort(rs.begin(), rs.end(), [](const Rectangle* a, const Rectangle* b)
+			{ return a->fill_color().as_int() < b->fill_color().as_int(); });
+		const Rectangle* last = nullptr;		// Last drawn rectangle
+		for (const Rectangle* r : rs)
+			if (r->fill_color().visibility()) {		// Fill only if fill color is visible
+				if (last == nullptr || last->fill_color().as_int() != r->fill_color().as_int())
+					painter().set_color(r->fill_color().as_int());		// Set fill color of group
+				painter().rectf(r->point(0).x, r->point(0).y, r->width(), r->height());
+				last = r;
+			}
+		// Draw lines grouped by color and style
+		std::sort(rs.begin(), rs.end(), [](const Rectangle* a, const Rectangle* b) {
+			if (a->color().as_int() != b->color().as_int()) return a->color().as_int() < b->color().as_int();
+			if (a->style().style() != b->style().style()) return a->style().style() < b->style().style();
+			return a->style().width() < b->style().width();
+		});
+		last = nullptr;
+		for (const Rectangle* r : rs)
+			if (r->color().visibility()) {		// Draw only if color is visible
+				if (last == nullptr || last->color().as_int() != r->color().as_int())
+					painter().set_color(r->color().as_int());		// Set color of group
+				if (last == nullptr || last->style().style() != r->style().style()
+					|| last->style().width() != r->style().width())
+					painter().set_style(r->style().style(), r->style().width());	// Set style of group
+				painter().rect(r->point(0).x, r->point(0).y, r->width(), r->height());
+				last = r;
+			}
 	}
 
 	// Determines either cell is inside grid
 	bool is_grid(const Grid& grid, const Rectangle& cell)
 	{
-		// Validation of x-coordinate (first line) and y-coordinate (second line)
-		return grid.point(0).x <= cell.point(0).x && cell.point(0).x + cell.width() <= grid.point(0).x + grid.width()
-			&& grid.point(0).y <= cell.point(0).y && cell.point(0).y + cell.height() <= grid.point(0).y + grid.height();
+		return is_inside(Box{ cell.point(0), cell.width(), cell.height() }, Box{ grid.point(0), grid.width(), grid.height() });
 	}
 
 	//------------------------------------------------------------------------------
@@ -8,11 +8,19 @@
 #include <stdexcept>
 #include <vector>
 #include <list>
+#include <map>
+#include <functional>
+#include <unordered_map>
+#include <memory>
+#include <new>
+#include <utility>
+#include <type_traits>
 #include <initializer_list>
 #include <string>
 #include <sstream>
 #include "fltk.h"
 #include "Point.h"
+#include "Painter.h"
 
 //------------------------------------------------------------------------------
 
@@ -123,6 +131,73 @@ namespace Graph_lib {
 
 	//------------------------------------------------------------------------------
 
+	// Memory for objects destroyed all together; objects are placed one after another
+	// in large blocks, so they're created without separate allocations and all their
+	// memory is freed at once, block by block
+	class Arena {
+	public:
+		using size_type = std::size_t;
+
+		static constexpr size_type default_block = 16384;	// Default size of block in bytes
+
+		// Construction
+		explicit Arena(size_type block_sz = default_block) : blk_sz{ block_sz }, cur{ nullptr }, left{ 0 } { }
+
+		// Destruction (objects are destroyed in reverse order of their creation)
+		~Arena() { clear(); }
+
+		// Creation and removal of objects
+		template<typename T, typename... Args>
+		T* make(Args&&... args);		// Create object of type T from args
+		void clear();					// Destroy all objects
+
+		// Forbidden copying
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+	private:
+		struct Destructor {		// Destructor of object
+			void(*destroy)(void*);
+			void* obj;
+		};
+
+		size_type blk_sz;							// Size of block
+		std::vector<std::unique_ptr<char[]>> blocks;	// All blocks
+		char* cur;									// Free memory of last block
+		size_type left;								// Size of free memory of last block
+		std::vector<Destructor> dtors;				// Destructors of created objects
+
+		// Helper function
+		void* allocate(size_type sz, size_type align);	// Memory of sz bytes, aligned with align
+	};
+
+	// Creates object of type T from args inside of arena; returns address of object
+	template<typename T, typename... Args>
+	T* Arena::make(Args&&... args)
+	{
+		void* mem = allocate(sizeof(T), alignof(T));
+		if (std::is_trivially_destructible<T>::value)		// Nothing to destroy
+			return new(mem) T(std::forward<Args>(args)...);
+		// Keep place for destructor before construction, so that objects created by
+		// constructor of T in this arena are destroyed before T
+		const size_type k = dtors.size();
+		dtors.push_back(Destructor{ [](void* p) { static_cast<T*>(p)->~T(); }, nullptr });
+		T* obj = nullptr;
+		try {
+			obj = new(mem) T(std::forward<Args>(args)...);
+		}
+		catch (...) {		// Handle of failed construction
+			dtors.erase(dtors.begin() + k);
+			throw;
+		}
+		dtors[k].obj = obj;
+		return obj;
+	}
+
+	//------------------------------------------------------------------------------
+
+	// Note: elements are owned either by vector (heap) or by arena (if vector was constructed
+	// with arena); elements owned by arena are removed with arena, not by vector
 	template<typename T>		// Requires Element<T>()
 	class Vector_ref {
 	public:
@@ -138,6 +213,7 @@ namespace Graph_lib {
 
 		// Construction
 		Vector_ref() = default;
+		explicit Vector_ref(Arena* a) : ar{ a } { }		// Elements created by vector are owned by a
 
 		// Destruction
 		~Vector_ref() { for (auto& ptr : owned) delete ptr; }
@@ -146,6 +222,8 @@ namespace Graph_lib {
 		void push_back(reference val) { vec.push_back(&val); }
 		void push_back(pointer ptr)		// Insertion of owned element
 		{ vec.push_back(ptr); owned.push_back(ptr); }
+		template<typename U = T, typename... Args>		// Requires Derived<U, T>()
+		reference make_back(Args&&... args);	// Insertion of element of type U, created from args
 		void pop_back(bool own);		// Own determines either removal element is owned or not
 
 		// Access to parameters (writing)
@@ -168,8 +246,21 @@ namespace Graph_lib {
 	private:
 		std::vector<pointer> vec;		// All elements
 		std::vector<pointer> owned;		// Owned elements
+		Arena* ar = nullptr;			// Owner of created elements (nullptr for vector)
 	};
 
+	// Creates element of type U from args and adds it to end; element is owned
+	// by arena of vector if there's one, otherwise by vector itself
+	template<typename T>		// Requires Element<T>()
+	template<typename U, typename... Args>		// Requires Derived<U, T>()
+	typename Vector_ref<T>::reference Vector_ref<T>::make_back(Args&&... args)
+	{
+		if (ar != nullptr)
+			push_back(*ar->make<U>(std::forward<Args>(args)...));
+		else push_back(static_cast<pointer>(new U(std::forward<Args>(args)...)));
+		return back();
+	}
+
 	// Removes last element; if own is true removes last owned element as well
 	template<typename T>		// Requires Element<T>()
 	void Vector_ref<T>::pop_back(bool own)
@@ -186,6 +277,8 @@ namespace Graph_lib {
 
 	//------------------------------------------------------------------------------
 
+	// Note: elements are owned either by list (heap) or by arena (if list was constructed
+	// with arena); elements owned by arena are removed with arena, not by list
 	template<typename T>		// Requires Element<T>()
 	class List_ref {
 	public:
@@ -201,6 +294,7 @@ namespace Graph_lib {
 
 		// Construction
 		List_ref() = default;
+		explicit List_ref(Arena* a) : ar{ a } { }		// Elements created by list are owned by a
 
 		// Destruction
 		~List_ref() { for (auto& ptr : owned) delete ptr; }
@@ -212,6 +306,10 @@ namespace Graph_lib {
 		void push_back(reference val) { lst.push_back(&val); }
 		void push_back(pointer ptr)		// Insertion of owned element
 		{ lst.push_back(ptr); owned.push_back(ptr); }
+		template<typename U = T, typename... Args>		// Requires Derived<U, T>()
+		reference make_front(Args&&... args);	// Insertion of element of type U, created from args
+		template<typename U = T, typename... Args>		// Requires Derived<U, T>()
+		reference make_back(Args&&... args);	// Insertion of element of type U, created from args
 		void pop_front(bool own);		// own determines either removal element is owned or not
 		void pop_back(bool own);		// own determines either removal element is owned or not
 
@@ -233,8 +331,33 @@ namespace Graph_lib {
 	private:
 		std::list<pointer> lst;		// All elements
 		std::list<pointer> owned;	// Owned elements
+		Arena* ar = nullptr;		// Owner of created elements (nullptr for list)
 	};
 
+	// Creates element of type U from args and adds it to beginning; element is
+	// owned by arena of list if there's one, otherwise by list itself
+	template<typename T>		// Requires Element<T>()
+	template<typename U, typename... Args>		// Requires Derived<U, T>()
+	typename List_ref<T>::reference List_ref<T>::make_front(Args&&... args)
+	{
+		if (ar != nullptr)
+			push_front(*ar->make<U>(std::forward<Args>(args)...));
+		else push_front(static_cast<pointer>(new U(std::forward<Args>(args)...)));
+		return front();
+	}
+
+	// Creates element of type U from args and adds it to end; element is
+	// owned by arena of list if there's one, otherwise by list itself
+	template<typename T>		// Requires Element<T>()
+	template<typename U, typename... Args>		// Requires Derived<U, T>()
+	typename List_ref<T>::reference List_ref<T>::make_back(Args&&... args)
+	{
+		if (ar != nullptr)
+			push_back(*ar->make<U>(std::forward<Args>(args)...));
+		else push_back(static_cast<pointer>(new U(std::forward<Args>(args)...)));
+		return back();
+	}
+
 	// Removes first element; if own is true, then removes first owned element as well
 	template<typename T>		// Requires Element<T>()
 	void List_ref<T>::pop_front(bool own)
@@ -265,6 +388,66 @@ namespace Graph_lib {
 
 	//------------------------------------------------------------------------------
 
+	// Sequence of points keeping first few of them inside of itself, so that
+	// shapes of few points (rectangles, circles, texts) don't allocate memory
+	class Point_buffer {
+	public:
+		// Type definitions
+		using size_type = unsigned int;
+		using iterator = Point*;
+		using const_iterator = const Point*;
+
+		static constexpr size_type local_size = 4;		// Number of points kept inside of buffer
+
+		// Construction
+		Point_buffer() : sz{ 0 } { }
+
+		// Insertion
+		void push_back(Point p);
+
+		// Access to parameters (writing)
+		Point& operator[](size_type i) { return data()[i]; }
+		Point& front() { return data()[0]; }
+
+		// Access to parameters (reading)
+		const Point& operator[](size_type i) const { return data()[i]; }
+		const Point& front() const { return data()[0]; }
+		size_type size() const { return sz; }
+		bool empty() const { return sz == 0; }
+
+		// Iterator functions
+		iterator begin() { return data(); }
+		iterator end() { return data() + sz; }
+		const_iterator cbegin() const { return data(); }
+		const_iterator cend() const { return data() + sz; }
+
+	private:
+		Point local[local_size];	// First points (while size <= local_size)
+		std::vector<Point> heap;	// All points (when size > local_size)
+		size_type sz;				// Number of points
+
+		// Helper functions
+		Point* data() { return sz <= local_size ? local : heap.data(); }
+		const Point* data() const { return sz <= local_size ? local : heap.data(); }
+	};
+
+	// Adds p to end of buffer; moves points to heap once they don't fit into buffer
+	inline void Point_buffer::push_back(Point p)
+	{
+		if (sz < local_size)
+			local[sz] = p;
+		else {
+			if (sz == local_size) {		// Move points out of buffer
+				heap.reserve(local_size * 2);
+				heap.assign(local, local + local_size);
+			}
+			heap.push_back(p);
+		}
+		++sz;
+	}
+
+	//------------------------------------------------------------------------------
+
 	class Shape {	// Deals with color and style, and holds sequence of lines
 	public:
 		// Drawing of shape
@@ -283,6 +466,8 @@ namespace Graph_lib {
 		Color fill_color() const { return fcolor; }
 		Point point(unsigned int i) const { return points[i]; }
 		unsigned int number_of_points() const { return points.size(); }
+		Box extent() const { return ext; }	// Smallest box containing points of shape
+		virtual Box bounds() const { return widen(ext, lstyle.width()); }	// Area covered by drawing of shape
 
 		// Destruction
 		virtual ~Shape() { }
@@ -302,11 +487,12 @@ namespace Graph_lib {
 		virtual void draw_lines() const;	// Draw appropriate lines
 
 		// Access to parameters (writing)
-		void add(Point p) { points.push_back(p); }
-		void set_point(unsigned int i, Point p) { points[i] = p; }
+		void add(Point p) { points.push_back(p); ext |= Box{ p, 1, 1 }; }
+		void set_point(unsigned int i, Point p);
 
 	private:
-		std::vector<Point> points;	// Vertices of shape
+		Point_buffer points;		// Vertices of shape
+		Box ext;					// Smallest box containing points (kept on add, set_point and move)
 		Color lcolor;				// Color of lines
 		Line_style lstyle;			// Style of lines
 		Color fcolor;				// Fill color of lines
@@ -350,6 +536,7 @@ namespace Graph_lib {
 		// Access to parameters (reading)
 		unsigned int width() const { return w; }
 		unsigned int height() const { return h; }
+		Box bounds() const { return widen(Box{ point(0), w, h }, style().width()); }
 
 	private:
 		unsigned int w;		// Width
@@ -387,13 +574,24 @@ namespace Graph_lib {
 	class Polygon : public Closed_polyline {	// Closed sequence of non-intersecting lines
 	public:
 		// Construction
-		using Closed_polyline::Closed_polyline;
+		Polygon() { }
+		// Constructs polygon with points from lst or ps (checked all at once, in O(n * log(n)) time)
+		Polygon(std::initializer_list<Point> lst) : Polygon{ std::vector<Point>(lst) } { }
+		explicit Polygon(const std::vector<Point>& ps);
 
 		// Drawing of shape
 		void draw_lines() const;
 
 		// Access to parameters (writing)
-		void add(Point p);
+		void add(Point p);		// New line is checked only with k lines overlapping it by x, in O(log(n) + k) time
+
+	private:
+		// Lines are indexed by x relative to first point, so move() doesn't invalidate indices
+		std::multimap<long long, unsigned int> edges;	// Lines by x of left end, in order of sweep line
+		std::unordered_map<unsigned long long, std::vector<unsigned int>> spans;	// Segment tree of lines over x
+
+		// Helper functions
+		void add_edge(unsigned int i);			// Add line from point i to next one to edges and spans
 	};
 
 	//------------------------------------------------------------------------------
@@ -449,6 +647,7 @@ namespace Graph_lib {
 		std::string label() const { return lab; }
 		Font font() const { return fnt; }
 		unsigned int font_size() const { return fnt_sz; }
+		Box bounds() const;
 
 	private:
 		std::string lab;		// Label
@@ -473,6 +672,9 @@ namespace Graph_lib {
 		void move(int dx, int dy);
 		void set_color(Color c);
 
+		// Access to parameters (reading)
+		Box bounds() const { return Shape::bounds() | notches.bounds() | label.bounds(); }
+
 		Text label;
 		Lines notches;
 	};
@@ -494,6 +696,7 @@ namespace Graph_lib {
 
 		// Access to parameters (reading)
 		unsigned int radius() const { return r; }
+		Box bounds() const { return widen(Box{ point(0), r + r + 1, r + r + 1 }, style().width()); }
 		Point center() const { return Point{ point(0).x + static_cast<int>(r), point(0).y + static_cast<int>(r) }; }
 
 	private:
@@ -519,6 +722,7 @@ namespace Graph_lib {
 		// Access to parameters (reading)
 		unsigned int major() const { return w; }
 		unsigned int minor() const { return h; }
+		Box bounds() const { return widen(Box{ point(0), w + w + 1, h + h + 1 }, style().width()); }
 		Point center() const { return Point{ point(0).x + static_cast<int>(w), point(0).y + static_cast<int>(h) }; }
 		Point focus1() const { return w > h ? Point{ center().x - focus_distance(), center().y } : Point{ center().x, center().y - focus_distance() }; }
 		Point focus2() const { return w > h ? Point{ center().x + focus_distance(), center().y } : Point{ center().x, center().y + focus_distance() }; }
@@ -546,6 +750,9 @@ namespace Graph_lib {
 		void set_color(Color c);
 		void move(int dx, int dy);
 
+		// Access to parameters (reading)
+		Box bounds() const;
+
 		Text mark;
 	};
 
@@ -606,6 +813,9 @@ namespace Graph_lib {
 		void set_mask(Point xy, unsigned int ww, unsigned int hh) { w = ww; h = hh; cx = xy.x; cy = xy.y; }
 		void move(int dx, int dy) { Shape::move(dx, dy); pi->draw(point(0).x, point(0).y); }
 
+		// Access to parameters (reading)
+		Box bounds() const;
+
 	private:
 		// "Masking box"
 		unsigned int w, h;	// Width and height
@@ -617,8 +827,44 @@ namespace Graph_lib {
 	//------------------------------------------------------------------------------
 
 	// Invariant: cell_w >= 0, cell_h >= 0, h_num >= 0, v_num >= 0
+	// Note: cells are kept as arrays of their parameters, indexed by number of cell
 	class Grid : public Shape {
 	public:
+		enum class Layer {		// Parts of grid being drawn
+			all, fills, lines
+		};
+
+		class Const_cell {		// Reference to cell of grid (reading)
+		public:
+			// Construction
+			Const_cell(const Grid& g, unsigned int i) : grid{ &g }, ind{ i } { }
+
+			// Access to parameters (reading)
+			Point point(unsigned int) const { return grid->tl[ind]; }	// Top-left angle is only point of cell
+			unsigned int width() const { return grid->cell_w; }
+			unsigned int height() const { return grid->cell_h; }
+			Color color() const { return grid->color(); }
+			Line_style style() const { return grid->style(); }
+			Color fill_color() const { return grid->fills[ind]; }
+			Box bounds() const { return widen(Box{ grid->tl[ind], grid->cell_w, grid->cell_h }, style().width()); }
+
+		protected:
+			const Grid* grid;
+			unsigned int ind;	// Number of cell
+		};
+
+		class Cell : public Const_cell {	// Reference to cell of grid (writing and reading)
+		public:
+			// Construction
+			Cell(Grid& g, unsigned int i) : Const_cell{ g, i } { }
+
+			// Access to parameters (writing)
+			void set_fill_color(Color c) { owner().fills[ind] = c; owner().damaged(bounds()); }
+
+		private:
+			Grid& owner() const { return const_cast<Grid&>(*grid); }	// Cell is made only from non-const grid
+		};
+
 		// Construction
 		Grid(Point xy, unsigned int cell_w, unsigned int cell_h, unsigned int h_num, unsigned int v_num);
 
@@ -626,25 +872,40 @@ namespace Graph_lib {
 		void draw_lines() const;
 
 		// Access to parameters (writing)
-		void set_color(Color c);
 		void set_fill_color(Color c);
-		void set_style(Line_style ls);
 		void set_visibility(Color::Transparency vis);
 		void move(int dx, int dy);
-		Rectangle& operator[](unsigned int i) { return cells[i]; }
+		void set_layer(Layer l) { lay = l; }
+		// Sets d as function called with box of cells, fills of which were changed (e.g., Window::invalidate)
+		void set_damage(std::function<void(Box)> d) { damage = std::move(d); }
+		Cell operator[](unsigned int i) { return Cell{ *this, i }; }
 
 		// Access to parameters (reading)
-		unsigned int width() const;
-		unsigned int height() const;
-		unsigned int size() const { return cells.size(); }
-		const Rectangle& operator[](unsigned int i) const { return cells[i]; }
+		unsigned int width() const { return cell_w * h_num; }
+		unsigned int height() const { return cell_h * v_num; }
+		unsigned int size() const { return tl.size(); }
+		unsigned int index(Point xy) const;		// Number of cell at xy; size of grid if there's none
+		Const_cell operator[](unsigned int i) const { return Const_cell{ *this, i }; }
+		Box bounds() const { return widen(Box{ point(0), width(), height() }, style().width()); }
+		Layer layer() const { return lay; }
 
 	private:
-		Vector_ref<Rectangle> cells;
+		std::vector<Point> tl;			// Top-left angles of cells
+		std::vector<Color> fills;		// Fill colors of cells
+		unsigned int cell_w, cell_h;	// Size of each cell
+		unsigned int h_num, v_num;		// Number of columns and rows
+		Layer lay;						// Drawn part of grid
+		mutable std::vector<unsigned int> order;	// Order of drawing cells (kept between drawings)
+		std::function<void(Box)> damage;			// Receiver of changed areas (none if empty)
+
+		// Helper function
+		void damaged(Box b) const { if (damage) damage(b); }
 	};
 
-	// Helper function
+	// Helper functions
 	bool is_grid(const Grid& grid, const Rectangle& cell);
+	bool is_thin_line(const Shape& s);
+	void draw_batch(std::vector<const Rectangle*>& rs);
 
 	//------------------------------------------------------------------------------
 
@@ -0,0 +1,378 @@
+//------------------------------------------------------------------------------
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "Painter.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PAINTER_SSE2 1
+#endif
+
+//------------------------------------------------------------------------------
+
+namespace Graph_lib {
+
+	//------------------------------------------------------------------------------
+
+	static Fltk_painter fltk_painter;					// Default painter
+	static Painter* current_painter = &fltk_painter;	// Painter used by shapes
+
+	// Gets current painter
+	Painter& painter()
+	{
+		return *current_painter;
+	}
+
+	// Sets p as current painter (FLTK's one if p is NULL); returns previous painter
+	Painter* set_painter(Painter* p)
+	{
+		Painter* const old = current_painter;
+		current_painter = p != nullptr ? p : &fltk_painter;
+		return old;
+	}
+
+	// Converts c into pixel keeping bytes of red, green, blue and alpha in this order
+	std::uint32_t as_pixel(Fl_Color c)
+	{
+		unsigned char rgba[4] = { 0, 0, 0, 255 };
+		Fl::get_color(c, rgba[0], rgba[1], rgba[2]);
+		std::uint32_t pix;
+		std::memcpy(&pix, rgba, sizeof(pix));
+		return pix;
+	}
+
+	//------------------------------------------------------------------------------
+
+	// Fills polygon with vertices ps
+	void Fltk_painter::polygon(const std::vector<Point>& ps)
+	{
+		fl_begin_complex_polygon();
+		for (const Point& p : ps)
+			fl_vertex(p.x, p.y);
+		fl_end_complex_polygon();
+	}
+
+	// Draws part of img at (cx, cy) of size w * h with top-left angle at (x, y); whole img if w * h == 0
+	void Fltk_painter::image(Fl_Image& img, int x, int y, int w, int h, int cx, int cy)
+	{
+		if (w && h) img.draw(x, y, w, h, cx, cy);
+		else img.draw(x, y);
+	}
+
+	//------------------------------------------------------------------------------
+
+	// Fills n pixels starting at p with pix; four pixels are stored at once where SSE2 is available
+	static void fill_span(std::uint32_t* p, unsigned int n, std::uint32_t pix)
+	{
+#ifdef PAINTER_SSE2
+		const __m128i quad = _mm_set1_epi32(static_cast<int>(pix));
+		for (; n >= 8; n -= 8, p += 8) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(p), quad);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(p + 4), quad);
+		}
+		for (; n >= 4; n -= 4, p += 4)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(p), quad);
+#endif
+		for (; n > 0; --n)
+			*p++ = pix;
+	}
+
+	// Columns of symbols from ' ' to '~' of 5 * 7 font; bit i of column is row i from top,
+	// row 7 is below bottom line of text
+	static const unsigned char glyphs[][5] = {
+		{ 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5F, 0x00, 0x00 }, { 0x00, 0x07, 0x00, 0x07, 0x00 },
+		{ 0x14, 0x7F, 0x14, 0x7F, 0x14 }, { 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 },
+		{ 0x36, 0x49, 0x56, 0x20, 0x50 }, { 0x00, 0x08, 0x07, 0x03, 0x00 }, { 0x00, 0x1C, 0x22, 0x41, 0x00 },
+		{ 0x00, 0x41, 0x22, 0x1C, 0x00 }, { 0x2A, 0x1C, 0x7F, 0x1C, 0x2A }, { 0x08, 0x08, 0x3E, 0x08, 0x08 },
+		{ 0x00, 0x80, 0x70, 0x30, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 }, { 0x00, 0x00, 0x60, 0x60, 0x00 },
+		{ 0x20, 0x10, 0x08, 0x04, 0x02 }, { 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 },
+		{ 0x72, 0x49, 0x49, 0x49, 0x46 }, { 0x21, 0x41, 0x49, 0x4D, 0x33 }, { 0x18, 0x14, 0x12, 0x7F, 0x10 },
+		{ 0x27, 0x45, 0x45, 0x45, 0x39 }, { 0x3C, 0x4A, 0x49, 0x49, 0x31 }, { 0x41, 0x21, 0x11, 0x09, 0x07 },
+		{ 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x46, 0x49, 0x49, 0x29, 0x1E }, { 0x00, 0x00, 0x14, 0x00, 0x00 },
+		{ 0x00, 0x40, 0x34, 0x00, 0x00 }, { 0x00, 0x08, 0x14, 0x22, 0x41 }, { 0x14, 0x14, 0x14, 0x14, 0x14 },
+		{ 0x00, 0x41, 0x22, 0x14, 0x08 }, { 0x02, 0x01, 0x59, 0x09, 0x06 }, { 0x3E, 0x41, 0x5D, 0x59, 0x4E },
+		{ 0x7C, 0x12, 0x11, 0x12, 0x7C }, { 0x7F, 0x49, 0x49, 0x49, 0x36 }, { 0x3E, 0x41, 0x41, 0x41, 0x22 },
+		{ 0x7F, 0x41, 0x41, 0x41, 0x3E }, { 0x7F, 0x49, 0x49, 0x49, 0x41 }, { 0x7F, 0x09, 0x09, 0x09, 0x01 },
+		{ 0x3E, 0x41, 0x41, 0x51, 0x73 }, { 0x7F, 0x08, 0x08, 0x08, 0x7F }, { 0x00, 0x41, 0x7F, 0x41, 0x00 },
+		{ 0x20, 0x40, 0x41, 0x3F, 0x01 }, { 0x7F, 0x08, 0x14, 0x22, 0x41 }, { 0x7F, 0x40, 0x40, 0x40, 0x40 },
+		{ 0x7F, 0x02, 0x1C, 0x02, 0x7F }, { 0x7F, 0x04, 0x08, 0x10, 0x7F }, { 0x3E, 0x41, 0x41, 0x41, 0x3E },
+		{ 0x7F, 0x09, 0x09, 0x09, 0x06 }, { 0x3E, 0x41, 0x51, 0x21, 0x5E }, { 0x7F, 0x09, 0x19, 0x29, 0x46 },
+		{ 0x26, 0x49, 0x49, 0x49, 0x32 }, { 0x03, 0x01, 0x7F, 0x01, 0x03 }, { 0x3F, 0x40, 0x40, 0x40, 0x3F },
+		{ 0x1F, 0x20, 0x40, 0x20, 0x1F }, { 0x3F, 0x40, 0x38, 0x40, 0x3F }, { 0x63, 0x14, 0x08, 0x14, 0x63 },
+		{ 0x03, 0x04, 0x78, 0x04, 0x03 }, { 0x61, 0x59, 0x49, 0x4D, 0x43 }, { 0x00, 0x7F, 0x41, 0x41, 0x41 },
+		{ 0x02, 0x04, 0x08, 0x10, 0x20 }, { 0x00, 0x41, 0x41, 0x41, 0x7F }, { 0x04, 0x02, 0x01, 0x02, 0x04 },
+		{ 0x40, 0x40, 0x40, 0x40, 0x40 }, { 0x00, 0x03, 0x07, 0x08, 0x00 }, { 0x20, 0x54, 0x54, 0x78, 0x40 },
+		{ 0x7F, 0x28, 0x44, 0x44, 0x38 }, { 0x38, 0x44, 0x44, 0x44, 0x28 }, { 0x38, 0x44, 0x44, 0x28, 0x7F },
+		{ 0x38, 0x54, 0x54, 0x54, 0x18 }, { 0x00, 0x08, 0x7E, 0x09, 0x02 }, { 0x18, 0xA4, 0xA4, 0x9C, 0x78 },
+		{ 0x7F, 0x08, 0x04, 0x04, 0x78 }, { 0x00, 0x44, 0x7D, 0x40, 0x00 }, { 0x20, 0x40, 0x40, 0x3D, 0x00 },
+		{ 0x7F, 0x10, 0x28, 0x44, 0x00 }, { 0x00, 0x41, 0x7F, 0x40, 0x00 }, { 0x7C, 0x04, 0x78, 0x04, 0x78 },
+		{ 0x7C, 0x08, 0x04, 0x04, 0x78 }, { 0x38, 0x44, 0x44, 0x44, 0x38 }, { 0xFC, 0x18, 0x24, 0x24, 0x18 },
+		{ 0x18, 0x24, 0x24, 0x18, 0xFC }, { 0x7C, 0x08, 0x04, 0x04, 0x08 }, { 0x48, 0x54, 0x54, 0x54, 0x24 },
+		{ 0x04, 0x04, 0x3F, 0x44, 0x24 }, { 0x3C, 0x40, 0x40, 0x20, 0x7C }, { 0x1C, 0x20, 0x40, 0x20, 0x1C },
+		{ 0x3C, 0x40, 0x30, 0x40, 0x3C }, { 0x44, 0x28, 0x10, 0x28, 0x44 }, { 0x4C, 0x90, 0x90, 0x90, 0x7C },
+		{ 0x44, 0x64, 0x54, 0x4C, 0x44 }, { 0x00, 0x08, 0x36, 0x41, 0x00 }, { 0x00, 0x00, 0x77, 0x00, 0x00 },
+		{ 0x00, 0x41, 0x36, 0x08, 0x00 }, { 0x02, 0x01, 0x02, 0x04, 0x02 }
+	};
+
+	//------------------------------------------------------------------------------
+
+	// Constructs framebuffer of size w * h, filled with bg
+	Raster::Raster(unsigned int w, unsigned int h, Fl_Color bg)
+		: pixels(w * h), wd{ w }, ht{ h }, col{ FL_BLACK }, pix{ as_pixel(FL_BLACK) }, lwidth{ 1 },
+		dashes{}, phase{ 0 }, fnt_id{ FL_HELVETICA }, fnt_sz{ 14 }
+	{
+		clear(bg);
+	}
+
+	// Sets c as color of next primitives
+	void Raster::set_color(Fl_Color c)
+	{
+		col = c;
+		pix = as_pixel(c);
+	}
+
+	// Sets style and width of lines; lengths of dashes are taken from FLTK (dash is 3 widths, dot and gap are 1 width)
+	void Raster::set_style(int style, int width)
+	{
+		lwidth = std::max(width, 1);
+		const int dash = 3 * lwidth, dot = lwidth, gap = lwidth;
+		switch (style & 0xff) {		// Handle of kind of line (caps and joins are ignored)
+		case FL_DASH:
+			dashes = { dash, gap };
+			break;
+		case FL_DOT:
+			dashes = { dot, gap };
+			break;
+		case FL_DASHDOT:
+			dashes = { dash, gap, dot, gap };
+			break;
+		case FL_DASHDOTDOT:
+			dashes = { dash, gap, dot, gap, dot, gap };
+			break;
+		default:			// Solid line
+			dashes.clear();
+		}
+	}
+
+	// Fills whole framebuffer with c
+	void Raster::clear(Fl_Color c)
+	{
+		if (!pixels.empty()) fill_span(pixels.data(), pixels.size(), as_pixel(c));
+	}
+
+	// Fills pixels from x1 to x2 (inclusive) of row y with current color
+	void Raster::span(int x1, int x2, int y)
+	{
+		if (y < 0 || y >= static_cast<int>(ht)) return;		// Handle of rows out of framebuffer
+		x1 = std::max(x1, 0);
+		x2 = std::min(x2, static_cast<int>(wd) - 1);
+		if (x1 <= x2) fill_span(&pixels[y * wd + x1], x2 - x1 + 1, pix);
+	}
+
+	// Draws point (x, y) of line as square of width of line, unless it falls into gap between dashes
+	void Raster::dot(int x, int y)
+	{
+		if (!dashes.empty()) {		// Handle of dashed lines
+			unsigned int period = 0, pos = 0;
+			for (int d : dashes) period += d;
+			const unsigned int at = phase++ % period;
+			unsigned int i = 0;
+			for (; pos + dashes[i] <= at; ++i) pos += dashes[i];
+			if (i % 2) return;		// Gap
+		}
+		const int lo = -(lwidth - 1) / 2, hi = lwidth / 2;		// Square around (x, y)
+		for (int dy = lo; dy <= hi; ++dy)
+			span(x + lo, x + hi, y + dy);
+	}
+
+	// Draws line from (x1, y1) to (x2, y2) by Bresenham's algorithm; (x2, y2) is drawn if last
+	void Raster::segment(int x1, int y1, int x2, int y2, bool last)
+	{
+		const int dx = std::abs(x2 - x1), dy = -std::abs(y2 - y1);
+		const int sx = x1 < x2 ? 1 : -1, sy = y1 < y2 ? 1 : -1;
+		int err = dx + dy;
+		while (x1 != x2 || y1 != y2) {
+			dot(x1, y1);
+			const int e2 = 2 * err;
+			if (e2 >= dy) { err += dy; x1 += sx; }
+			if (e2 <= dx) { err += dx; y1 += sy; }
+		}
+		if (last) dot(x2, y2);
+	}
+
+	// Draws line from (x1, y1) to (x2, y2), both ends included
+	void Raster::line(int x1, int y1, int x2, int y2)
+	{
+		phase = 0;
+		if (y1 == y2 && dashes.empty() && lwidth == 1)		// Handle of horizontal solid lines
+			span(std::min(x1, x2), std::max(x1, x2), y1);
+		else
+			segment(x1, y1, x2, y2, true);
+	}
+
+	// Draws lines of rectangle with top-left angle at (x, y), covering w * h pixels
+	void Raster::rect(int x, int y, int w, int h)
+	{
+		if (w <= 0 || h <= 0) return;		// Handle of empty rectangle
+		const int r = x + w - 1, b = y + h - 1;		// Right and bottom lines
+		if (dashes.empty()) {		// Solid lines are filled by spans
+			const int lo = -(lwidth - 1) / 2, hi = lwidth / 2;
+			rectf(x + lo, y + lo, r - x + hi - lo + 1, hi - lo + 1);
+			rectf(x + lo, b + lo, r - x + hi - lo + 1, hi - lo + 1);
+			rectf(x + lo, y + lo, hi - lo + 1, b - y + hi - lo + 1);
+			rectf(r + lo, y + lo, hi - lo + 1, b - y + hi - lo + 1);
+			return;
+		}
+		phase = 0;		// Dashes continue around rectangle
+		segment(x, y, r, y, false);
+		segment(r, y, r, b, false);
+		segment(r, b, x, b, false);
+		segment(x, b, x, y, true);
+	}
+
+	// Fills rectangle with top-left angle at (x, y), covering w * h pixels
+	void Raster::rectf(int x, int y, int w, int h)
+	{
+		if (w <= 0 || h <= 0) return;		// Handle of empty rectangle
+		const int y1 = std::max(y, 0), y2 = std::min(y + h, static_cast<int>(ht));
+		for (int row = y1; row < y2; ++row)
+			span(x, x + w - 1, row);
+	}
+
+	// Fills polygon with vertices ps by even-odd rule; pixels are inside if their centers are
+	void Raster::polygon(const std::vector<Point>& ps)
+	{
+		if (ps.size() < 3) return;		// Handle of degenerate polygon
+		int top = ps[0].y, bottom = ps[0].y;
+		for (const Point& p : ps) {
+			top = std::min(top, p.y);
+			bottom = std::max(bottom, p.y);
+		}
+		top = std::max(top, 0);
+		bottom = std::min(bottom, static_cast<int>(ht) - 1);
+		std::vector<double> xs;			// Crossings of row with edges
+		for (int y = top; y <= bottom; ++y) {
+			const double yc = y + 0.5;
+			xs.clear();
+			for (unsigned int i = 0; i < ps.size(); ++i) {
+				const Point a = ps[i], b = ps[(i + 1) % ps.size()];
+				if ((a.y <= yc) != (b.y <= yc))
+					xs.push_back(a.x + (yc - a.y) * (b.x - a.x) / (b.y - a.y));
+			}
+			std::sort(xs.begin(), xs.end());
+			for (unsigned int i = 0; i + 1 < xs.size(); i += 2)
+				span(static_cast<int>(std::ceil(xs[i] - 0.5)), static_cast<int>(std::ceil(xs[i + 1] - 0.5)) - 1, y);
+		}
+	}
+
+	// Draws arc of ellipse inscribed into rectangle at (x, y) of size w * h from angle a1 to a2
+	// (in degrees, counterclockwise from 3 o'clock)
+	void Raster::arc(int x, int y, int w, int h, double a1, double a2)
+	{
+		if (w <= 0 || h <= 0) return;		// Handle of empty ellipse
+		static const double pi = std::acos(-1.0);
+		const double rx = (w - 1) / 2.0, ry = (h - 1) / 2.0, cx = x + rx, cy = y + ry;
+		const unsigned int n = std::max(8u,		// Number of chords (shorter than pixel)
+			static_cast<unsigned int>(std::ceil(pi * (rx + ry) * std::abs(a2 - a1) / 360.0)));
+		phase = 0;
+		int px = static_cast<int>(std::lround(cx + rx * std::cos(a1 * pi / 180)));
+		int py = static_cast<int>(std::lround(cy - ry * std::sin(a1 * pi / 180)));
+		for (unsigned int i = 1; i <= n; ++i) {
+			const double t = (a1 + (a2 - a1) * i / n) * pi / 180;
+			const int nx = static_cast<int>(std::lround(cx + rx * std::cos(t)));
+			const int ny = static_cast<int>(std::lround(cy - ry * std::sin(t)));
+			segment(px, py, nx, ny, i == n);
+			px = nx;
+			py = ny;
+		}
+	}
+
+	// Fills sector of ellipse inscribed into rectangle at (x, y) of size w * h from angle a1
+	// to a2 (in degrees, counterclockwise from 3 o'clock); whole ellipse is filled by spans
+	void Raster::pie(int x, int y, int w, int h, double a1, double a2)
+	{
+		if (w <= 0 || h <= 0) return;		// Handle of empty ellipse
+		static const double pi = std::acos(-1.0);
+		const double rx = w / 2.0, ry = h / 2.0, cx = x + rx, cy = y + ry;
+		const bool whole = a2 - a1 >= 360;
+		for (int row = std::max(y, 0); row < std::min(y + h, static_cast<int>(ht)); ++row) {
+			const double dy = (row + 0.5 - cy) / ry;
+			if (dy * dy > 1) continue;		// Handle of rows out of ellipse
+			const double half = rx * std::sqrt(1 - dy * dy);
+			const int x1 = static_cast<int>(std::ceil(cx - half - 0.5)), x2 = static_cast<int>(std::ceil(cx + half - 0.5)) - 1;
+			if (whole) {
+				span(x1, x2, row);
+				continue;
+			}
+			for (int col = x1; col <= x2; ++col) {		// Pixels of sector
+				double a = std::atan2(-dy, (col + 0.5 - cx) / rx) * 180 / pi - a1;
+				a -= 360 * std::floor(a / 360);
+				if (a <= a2 - a1) span(col, col, row);
+			}
+		}
+	}
+
+	// Draws s with bottom-left angle at (x, y) using built-in font scaled to size of current font
+	void Raster::text(const std::string& s, int x, int y)
+	{
+		const int scale = std::max(1, (fnt_sz + 5) / 10);		// Size of font's point
+		for (unsigned char ch : s) {
+			if (ch < ' ' || ch > '~') ch = '?';		// Handle of symbols out of font
+			for (int c = 0; c < 5; ++c)
+				for (int r = 0; r < 8; ++r)
+					if (glyphs[ch - ' '][c] & (1 << r))
+						rectf(x + c * scale, y + (r - 7) * scale, scale, scale);
+			x += 6 * scale;
+		}
+	}
+
+	// Copies part of img at (cx, cy) of size w * h to (x, y); whole img is copied if w * h == 0.
+	// Only decoded images with one block of pixels can be copied; pixels with alpha below half are skipped
+	void Raster::image(Fl_Image& img, int x, int y, int w, int h, int cx, int cy)
+	{
+		const int d = img.d();
+		if (img.count() != 1 || d < 1 || d > 4 || img.data() == nullptr) return;	// Handle of unsupported images
+		if (!(w && h)) {
+			w = img.w();
+			h = img.h();
+			cx = cy = 0;
+		}
+		const unsigned char* data = reinterpret_cast<const unsigned char*>(img.data()[0]);
+		const int ld = img.ld() ? img.ld() : img.w() * d;		// Length of row of image
+		for (int r = std::max(0, -cy); r < h && cy + r < img.h(); ++r)
+			for (int c = std::max(0, -cx); c < w && cx + c < img.w(); ++c) {
+				const int px = x + c, py = y + r;
+				if (px < 0 || py < 0 || px >= static_cast<int>(wd) || py >= static_cast<int>(ht)) continue;
+				const unsigned char* p = data + (cy + r) * ld + (cx + c) * d;
+				if ((d == 2 || d == 4) && p[d - 1] < 128) continue;		// Transparent pixel
+				unsigned char rgba[4] = { p[0], p[0], p[0], 255 };
+				if (d >= 3) {
+					rgba[1] = p[1];
+					rgba[2] = p[2];
+				}
+				std::memcpy(&pixels[py * wd + px], rgba, sizeof(rgba));
+			}
+	}
+
+	// Writes framebuffer into os as binary PPM image
+	void Raster::write_ppm(std::ostream& os) const
+	{
+		os << "P6\n" << wd << ' ' << ht << "\n255\n";
+		std::vector<char> row(wd * 3);
+		for (unsigned int y = 0; y < ht; ++y) {
+			for (unsigned int x = 0; x < wd; ++x) {
+				unsigned char rgba[4];
+				std::memcpy(rgba, &pixels[y * wd + x], sizeof(rgba));
+				std::memcpy(&row[x * 3], rgba, 3);
+			}
+			os.write(row.data(), row.size());
+		}
+	}
+
+	//------------------------------------------------------------------------------
+
+}	// of namespace Graph_lib
+
+//------------------------------------------------------------------------------
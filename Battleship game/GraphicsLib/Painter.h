@@ -0,0 +1,148 @@
+//------------------------------------------------------------------------------
+
+#ifndef PAINTER_GUARD
+#define PAINTER_GUARD 1
+
+//------------------------------------------------------------------------------
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <ostream>
+#include "fltk.h"
+#include "Point.h"
+
+//------------------------------------------------------------------------------
+
+namespace Graph_lib {
+
+	//------------------------------------------------------------------------------
+
+	// Backend of drawing; shapes draw their lines using current painter
+	// Note: sizes and angles follow FLTK's drawing functions (fl_rect, fl_arc, etc.)
+	class Painter {
+	public:
+		// Destruction
+		virtual ~Painter() { }
+
+		// Access to parameters (writing)
+		virtual void set_color(Fl_Color c) = 0;
+		virtual void set_style(int style, int width) = 0;
+		virtual void set_font(int fnt, int sz) = 0;
+
+		// Access to parameters (reading)
+		virtual Fl_Color color() const = 0;
+		virtual int font() const = 0;
+		virtual int font_size() const = 0;
+		virtual bool is_visible(int x, int y, int w, int h) const = 0;	// Area crosses area being drawn
+
+		// Drawing of primitives (using current color, style and font)
+		virtual void line(int x1, int y1, int x2, int y2) = 0;
+		virtual void rect(int x, int y, int w, int h) = 0;			// Lines of rectangle
+		virtual void rectf(int x, int y, int w, int h) = 0;			// Fill of rectangle
+		virtual void polygon(const std::vector<Point>& ps) = 0;		// Fill of polygon
+		virtual void arc(int x, int y, int w, int h, double a1, double a2) = 0;	// Lines of ellipse's arc
+		virtual void pie(int x, int y, int w, int h, double a1, double a2) = 0;	// Fill of ellipse's sector
+		virtual void text(const std::string& s, int x, int y) = 0;	// Bottom-left angle at (x, y)
+		virtual void image(Fl_Image& img, int x, int y, int w, int h, int cx, int cy) = 0;	// Whole if w * h == 0
+	};
+
+	//------------------------------------------------------------------------------
+
+	// Painter drawing by FLTK into current window or offscreen
+	class Fltk_painter : public Painter {
+	public:
+		// Access to parameters (writing)
+		void set_color(Fl_Color c) override { fl_color(c); }
+		void set_style(int style, int width) override { fl_line_style(style, width); }
+		void set_font(int fnt, int sz) override { fl_font(fnt, sz); }
+
+		// Access to parameters (reading)
+		Fl_Color color() const override { return fl_color(); }
+		int font() const override { return fl_font(); }
+		int font_size() const override { return fl_size(); }
+		bool is_visible(int x, int y, int w, int h) const override { return fl_not_clipped(x, y, w, h) != 0; }
+
+		// Drawing of primitives
+		void line(int x1, int y1, int x2, int y2) override { fl_line(x1, y1, x2, y2); }
+		void rect(int x, int y, int w, int h) override { fl_rect(x, y, w, h); }
+		void rectf(int x, int y, int w, int h) override { fl_rectf(x, y, w, h); }
+		void polygon(const std::vector<Point>& ps) override;
+		void arc(int x, int y, int w, int h, double a1, double a2) override { fl_arc(x, y, w, h, a1, a2); }
+		void pie(int x, int y, int w, int h, double a1, double a2) override { fl_pie(x, y, w, h, a1, a2); }
+		void text(const std::string& s, int x, int y) override { fl_draw(s.c_str(), x, y); }
+		void image(Fl_Image& img, int x, int y, int w, int h, int cx, int cy) override;
+	};
+
+	//------------------------------------------------------------------------------
+
+	// Invariant: pixels.size() == w * h
+	// Note: each pixel keeps bytes of red, green, blue and alpha in this order; text is
+	// drawn with built-in 5 * 7 font, so rendering doesn't need display or fonts of system
+	class Raster : public Painter {		// Painter drawing into framebuffer in memory
+	public:
+		// Construction
+		Raster(unsigned int w, unsigned int h, Fl_Color bg = FL_WHITE);
+
+		// Access to parameters (writing)
+		void set_color(Fl_Color c) override;
+		void set_style(int style, int width) override;
+		void set_font(int fnt, int sz) override { fnt_id = fnt; fnt_sz = sz; }
+		void clear(Fl_Color c);		// Fill whole framebuffer with c
+
+		// Access to parameters (reading)
+		Fl_Color color() const override { return col; }
+		int font() const override { return fnt_id; }
+		int font_size() const override { return fnt_sz; }
+		bool is_visible(int x, int y, int w, int h) const override
+		{ return w > 0 && h > 0 && x < static_cast<int>(wd) && y < static_cast<int>(ht) && x + w > 0 && y + h > 0; }
+		unsigned int width() const { return wd; }
+		unsigned int height() const { return ht; }
+		std::uint32_t pixel(int x, int y) const { return pixels[y * wd + x]; }
+		const std::vector<std::uint32_t>& data() const { return pixels; }
+
+		// Drawing of primitives
+		void line(int x1, int y1, int x2, int y2) override;
+		void rect(int x, int y, int w, int h) override;
+		void rectf(int x, int y, int w, int h) override;
+		void polygon(const std::vector<Point>& ps) override;
+		void arc(int x, int y, int w, int h, double a1, double a2) override;
+		void pie(int x, int y, int w, int h, double a1, double a2) override;
+		void text(const std::string& s, int x, int y) override;
+		void image(Fl_Image& img, int x, int y, int w, int h, int cx, int cy) override;
+
+		// Output of framebuffer
+		void write_ppm(std::ostream& os) const;		// Binary PPM (P6), alpha is dropped
+
+	private:
+		std::vector<std::uint32_t> pixels;	// Framebuffer (by rows)
+		unsigned int wd, ht;				// Size of framebuffer
+		Fl_Color col;						// Current color
+		std::uint32_t pix;					// Current color as pixel
+		int lwidth;							// Width of lines (at least 1)
+		std::vector<int> dashes;			// Lengths of dashes and gaps (empty for solid lines)
+		unsigned int phase;					// Position in pattern of dashes
+		int fnt_id, fnt_sz;					// Current font and its size
+
+		// Helper functions
+		void span(int x1, int x2, int y);	// Fill pixels [x1:x2] of row y
+		void dot(int x, int y);				// Draw point of line with its width and dashes
+		void segment(int x1, int y1, int x2, int y2, bool last);	// Draw line, with or without last point
+	};
+
+	//------------------------------------------------------------------------------
+
+	// Helper functions
+	Painter& painter();						// Current painter (FLTK's by default)
+	Painter* set_painter(Painter* p);		// Set p (FLTK's if NULL) as current painter; previous one is returned
+	std::uint32_t as_pixel(Fl_Color c);		// Red, green, blue and alpha bytes of c
+
+	//------------------------------------------------------------------------------
+
+}	// of namespace Graph_lib
+
+//------------------------------------------------------------------------------
+
+#endif
+
+//------------------------------------------------------------------------------
@@ -31,6 +31,45 @@ namespace Graph_lib {
 	inline std::ostream& operator<<(std::ostream& os, const Point& p)
 	{ return os << '(' << p.x << ", " << p.y << ')'; }
 
+	//------------------------------------------------------------------------------
+
+	// Invariant: w >= 0, h >= 0
+	struct Box {		// Area of window, aligned with axes
+		// Construction
+		Box(Point xy, unsigned int ww, unsigned int hh) : x{ xy.x }, y{ xy.y }, w{ ww }, h{ hh } { }
+		Box() : x{ 0 }, y{ 0 }, w{ 0 }, h{ 0 } { }
+
+		// Access to data (reading)
+		bool empty() const { return w == 0 || h == 0; }
+		bool contains(Point p) const
+		{ return x <= p.x && p.x < x + static_cast<int>(w) && y <= p.y && p.y < y + static_cast<int>(h); }
+
+		int x, y;				// Top-left angle
+		unsigned int w, h;		// Width and height
+	};
+
+	// Helper functions
+	// Determines smallest box containing a and b; empty boxes are ignored
+	inline Box operator|(Box a, Box b)
+	{
+		if (a.empty()) return b;
+		if (b.empty()) return a;
+		const int x1 = a.x < b.x ? a.x : b.x, y1 = a.y < b.y ? a.y : b.y;
+		const int x2 = a.x + static_cast<int>(a.w) > b.x + static_cast<int>(b.w) ? a.x + static_cast<int>(a.w) : b.x + static_cast<int>(b.w);
+		const int y2 = a.y + static_cast<int>(a.h) > b.y + static_cast<int>(b.h) ? a.y + static_cast<int>(a.h) : b.y + static_cast<int>(b.h);
+		return Box{ Point{ x1, y1 }, static_cast<unsigned int>(x2 - x1), static_cast<unsigned int>(y2 - y1) };
+	}
+	inline Box& operator|=(Box& a, Box b) { return a = a | b; }
+	// Determines either a lies inside of b
+	inline bool is_inside(Box a, Box b)
+	{
+		return b.x <= a.x && a.x + static_cast<int>(a.w) <= b.x + static_cast<int>(b.w)
+			&& b.y <= a.y && a.y + static_cast<int>(a.h) <= b.y + static_cast<int>(b.h);
+	}
+	// Determines box b widened by d at each side
+	inline Box widen(Box b, unsigned int d)
+	{ return Box{ Point{ b.x - static_cast<int>(d), b.y - static_cast<int>(d) }, b.w + d + d, b.h + d + d }; }
+
 }
 
 //------------------------------------------------------------------------------
@@ -10,16 +10,35 @@ namespace Graph_lib {
 
 	//------------------------------------------------------------------------------
 
+	static bool headless = false;		// Windows aren't shown
+
+	// Sets either windows constructed from now on are shown; headless windows need no
+	// display, their shapes can be drawn into framebuffer by render()
+	void set_headless(bool h)
+	{
+		headless = h;
+	}
+
+	// Determines either windows constructed from now on aren't shown
+	bool is_headless()
+	{
+		return headless;
+	}
+
+	//------------------------------------------------------------------------------
+
 	// Constructs window at default location, of size ww * hh, titled with lab
 	Window::Window(unsigned int ww, unsigned int hh, const std::string& lab)
-		: Fl_Double_Window{ ww, hh, lab.c_str() }, w{ ww }, h{ hh }
+		: Fl_Double_Window{ ww, hh, lab.c_str() }, layer{ 0 }, layer_valid{ false }, w{ ww }, h{ hh },
+		index{ ww, hh }, top{ 0 }
 	{
 		init();
 	}
 
 	// Constructs window at xy, of size ww * hh, titled with lab
 	Window::Window(Point xy, unsigned int ww, unsigned int hh, const std::string& lab)
-		: Fl_Double_Window{ xy.x, xy.y, ww, hh, lab.c_str() }, w{ ww }, h{ hh }
+		: Fl_Double_Window{ xy.x, xy.y, ww, hh, lab.c_str() }, layer{ 0 }, layer_valid{ false }, w{ ww }, h{ hh },
+		index{ ww, hh }, top{ 0 }
 	{
 		init();
 	}
@@ -27,19 +46,53 @@ namespace Graph_lib {
 	// Initializes window with default parameters
 	void Window::init()
 	{
+		std::fill(shown, shown + layers, true);
 		//resizable(this);
-		show();
+		if (!headless) show();
+	}
+
+	// Destroys window and drawing of its static layer
+	Window::~Window()
+	{
+		if (layer) fl_delete_offscreen(layer);
+		Fl::remove_timeout(cb_timer, this);
+		Fl::remove_timeout(cb_frame, this);
 	}
 
 	//------------------------------------------------------------------------------
 
-	// Draws window, widgets and shapes
+	// Draws window, widgets, static layer and shapes; only shapes crossing
+	// damaged area are drawn if part of window was invalidated
 	void Window::draw()
 	{
 		Fl_Double_Window::draw();
-		// Draw shapes
-		for (unsigned int i = 0; i < shapes.size(); ++i)
-			shapes[i]->draw();
+		if (shown[static_cast<unsigned int>(Layer::background)])
+			draw_static();
+		// Draw shapes of visible layers
+		for (unsigned int l = static_cast<unsigned int>(Layer::background) + 1; l < layers; ++l)
+			if (shown[l])
+				for (const Shape* s : scene[l])
+					s->draw();
+	}
+
+	// Draws background and shapes of visible layers by p, from background to overlays;
+	// widgets aren't drawn, so p can draw window without display (e.g., into Raster)
+	void Window::render(Painter& p) const
+	{
+		Painter* const old = set_painter(&p);
+		try {
+			p.set_color(color());		// Background of window
+			p.rectf(0, 0, w, h);
+			for (unsigned int l = 0; l < layers; ++l)
+				if (shown[l])
+					for (const Shape* s : scene[l])
+						s->draw();
+		}
+		catch (...) {
+			set_painter(old);		// Restore painter of FLTK
+			throw;
+		}
+		set_painter(old);
 	}
 
 	// Attaches w to window
@@ -56,27 +109,269 @@ namespace Graph_lib {
 		w.hide();		// Remove w from window
 	}
 
-	// Attaches s to window
-	void Window::attach(Shape& s)
+	// Attaches s on top of shapes of layer l; s attached to background layer is drawn
+	// once and then copied from drawing of layer until invalidate_static() is called
+	void Window::attach(Shape& s, Layer l)
 	{
-		shapes.push_back(&s);		// Add s to shapes
+		detach(s);		// Attached shape is moved to l
+		Shapes& shapes = scene[static_cast<unsigned int>(l)];
+		places.emplace(&s, std::make_pair(l, shapes.insert(shapes.end(), &s)));	// Add s to shapes
+		index.insert(s, static_cast<unsigned int>(l), ++top);
+		if (l == Layer::background) invalidate_static();
 	}
 
 	// Detathes s from window
 	void Window::detach(Shape& s)
 	{
-		// Remove s from shapes
-		auto pos = std::remove(shapes.begin(), shapes.end(), &s);
-		shapes.erase(pos, shapes.end());
+		const auto pos = places.find(&s);
+		if (pos == places.end()) return;		// Handle of not attached shape
+		const Layer l = pos->second.first;
+		scene[static_cast<unsigned int>(l)].erase(pos->second.second);	// Remove s from shapes
+		places.erase(pos);
+		index.erase(s);
+		if (l == Layer::background) invalidate_static();
 	}
 
-	// Puts s on top of other shapes
+	// Puts s on top of other shapes of its layer
 	void Window::put_on_top(Shape& s)
 	{
-		// Make s last attached to window shape
-		auto pos = std::find(shapes.begin(), shapes.end(), &s);
-		if (pos != shapes.end())	// Shift all shapes from s to left by one
-			std::rotate(pos, std::next(pos), shapes.end());
+		const auto pos = places.find(&s);
+		if (pos == places.end()) return;		// Handle of not attached shape
+		Shapes& shapes = scene[static_cast<unsigned int>(pos->second.first)];
+		shapes.splice(shapes.end(), shapes, pos->second.second);		// Iterator stays valid
+		index.set_order(s, ++top);
+		if (pos->second.first == Layer::background) invalidate_static();
+	}
+
+	// Shows (if vis) or hides layer l; shapes of hidden layer aren't drawn or picked
+	void Window::set_layer_visibility(Layer l, bool vis)
+	{
+		if (shown[static_cast<unsigned int>(l)] == vis) return;		// Handle of unchanged visibility
+		shown[static_cast<unsigned int>(l)] = vis;
+		index.set_visibility(static_cast<unsigned int>(l), vis);
+		redraw();
+	}
+
+	// Moves s dx by x-coordinate and dy by y-coordinate; redraws its old and new areas
+	void Window::move(Shape& s, int dx, int dy)
+	{
+		invalidate(s);
+		s.move(dx, dy);
+		reindex(s);
+		invalidate(s);
+	}
+
+	// Updates place of s in index; call it after box of s was changed not by move()
+	void Window::reindex(Shape& s)
+	{
+		index.update(s);
+	}
+
+	// Finds topmost visible shape, box of which contains xy
+	Shape* Window::pick(Point xy) const
+	{
+		return index.find(xy);
+	}
+
+	// Marks area of s as damaged
+	void Window::invalidate(const Shape& s)
+	{
+		invalidate(s.bounds());
+	}
+
+	// Marks b as damaged; damaged areas are collected and passed to FLTK once per
+	// frame, so next drawing redraws them only instead of redrawing whole window
+	void Window::invalidate(Box b)
+	{
+		if (b.empty()) return;		// Ignore empty areas
+		if (damaged.empty())		// First area of frame
+			Fl::add_timeout(frame_time, cb_frame, this);
+		damaged.push_back(b);
+	}
+
+	// Damages areas invalidated since last frame
+	void Window::cb_frame(void* win)
+	{
+		Window& w = *static_cast<Window*>(win);
+		for (const Box& b : w.damaged)
+			w.damage(FL_DAMAGE_USER1, b.x, b.y, b.w, b.h);
+		w.damaged.clear();
+	}
+
+	// Marks static layer as outdated; call it after any static shape was changed
+	void Window::invalidate_static()
+	{
+		layer_valid = false;
+		redraw();		// Area of layer can change, so redraw whole window
+	}
+
+	// Schedules act to be called by event loop in delay seconds; actions scheduled
+	// to same time are called in order of scheduling
+	void Window::schedule(double delay, std::function<void()> act)
+	{
+		const auto at = std::chrono::steady_clock::now()
+			+ std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>{ std::max(delay, 0.0) });
+		actions.emplace(at, std::move(act));
+		arm_timer();
+	}
+
+	// Drops all scheduled actions
+	void Window::cancel_scheduled()
+	{
+		actions.clear();
+		Fl::remove_timeout(cb_timer, this);
+	}
+
+	// Sets timer to time of first scheduled action
+	void Window::arm_timer()
+	{
+		Fl::remove_timeout(cb_timer, this);
+		if (actions.empty()) return;		// Handle of no actions
+		const std::chrono::duration<double> left = actions.begin()->first - std::chrono::steady_clock::now();
+		Fl::add_timeout(std::max(left.count(), 0.0), cb_timer, this);
+	}
+
+	// Calls actions, time of which has come, and waits for next one
+	void Window::cb_timer(void* win)
+	{
+		Window& w = *static_cast<Window*>(win);
+		const auto now = std::chrono::steady_clock::now();
+		while (!w.actions.empty() && w.actions.begin()->first <= now) {
+			const std::function<void()> act = std::move(w.actions.begin()->second);
+			w.actions.erase(w.actions.begin());
+			act();		// Can schedule new actions
+		}
+		w.arm_timer();
+	}
+
+	// Copies static layer into window; redraws static shapes into layer if it is outdated
+	void Window::draw_static()
+	{
+		if (!layer_valid) {		// Redraw outdated layer
+			if (!layer) layer = fl_create_offscreen(w, h);
+			fl_begin_offscreen(layer);
+			fl_color(color());				// Background of window
+			fl_rectf(0, 0, w, h);
+			layer_area = Box{};
+			for (const Shape* s : scene[static_cast<unsigned int>(Layer::background)]) {
+				s->draw();
+				// Only visible shapes are copied, so widgets under invisible ones stay visible
+				if (s->color().visibility() || s->fill_color().visibility())
+					layer_area |= s->bounds();
+			}
+			fl_end_offscreen();
+			layer_valid = true;
+		}
+		if (!layer_area.empty())
+			fl_copy_offscreen(layer_area.x, layer_area.y, layer_area.w, layer_area.h, layer, layer_area.x, layer_area.y);
+	}
+
+	//------------------------------------------------------------------------------
+
+	// Constructs index of area of size w * h, split into buckets of size bucket_sz * bucket_sz
+	Shape_index::Shape_index(unsigned int w, unsigned int h, unsigned int bsz)
+		: bucket_sz{ bsz }, cols{ 0 }, rows{ 0 }, hidden{}
+	{
+		if (bucket_sz == 0)		// Handle of empty buckets
+			throw std::invalid_argument("Bad Shape_index: non-positive size of bucket");
+		cols = std::max((w + bucket_sz - 1) / bucket_sz, 1u);
+		rows = std::max((h + bucket_sz - 1) / bucket_sz, 1u);
+		buckets.resize(cols * rows);
+	}
+
+	// Adds s to index with layer and order as its rank; shapes of higher layer are above
+	// shapes of lower one, and shapes of higher order are above others in same layer
+	void Shape_index::insert(Shape& s, unsigned int layer, unsigned int order)
+	{
+		erase(s);		// Indexed shape is ranked anew
+		const Entry e{ s.bounds(), layer, order };
+		entries.emplace(&s, e);
+		place(&s, e.area);
+	}
+
+	// Removes s from index
+	void Shape_index::erase(Shape& s)
+	{
+		const auto pos = entries.find(&s);
+		if (pos == entries.end()) return;		// Handle of not indexed shape
+		remove(&s, pos->second.area);
+		entries.erase(pos);
+	}
+
+	// Moves s to buckets crossed by its current box
+	void Shape_index::update(Shape& s)
+	{
+		const auto pos = entries.find(&s);
+		if (pos == entries.end()) return;		// Handle of not indexed shape
+		remove(&s, pos->second.area);
+		pos->second.area = s.bounds();
+		place(&s, pos->second.area);
+	}
+
+	// Sets order as rank of s in its layer
+	void Shape_index::set_order(Shape& s, unsigned int order)
+	{
+		const auto pos = entries.find(&s);
+		if (pos != entries.end()) pos->second.order = order;
+	}
+
+	// Shows (if vis) or hides shapes of layer
+	void Shape_index::set_visibility(unsigned int layer, bool vis)
+	{
+		if (layer >= hidden.size()) hidden.resize(layer + 1, false);
+		hidden[layer] = !vis;
+	}
+
+	// Finds visible shape of highest rank, indexed box of which contains p; NULL if there's none
+	Shape* Shape_index::find(Point p) const
+	{
+		Shape* res = nullptr;
+		const Entry* best = nullptr;
+		for (Shape* s : buckets[row(p.y) * cols + col(p.x)]) {
+			const Entry& e = entries.at(s);
+			if (!e.area.contains(p) || (e.layer < hidden.size() && hidden[e.layer])
+				|| !(s->color().visibility() || s->fill_color().visibility()))
+				continue;		// Skip shapes not covering p
+			if (best == nullptr || e.layer > best->layer || (e.layer == best->layer && e.order > best->order)) {
+				res = s;
+				best = &e;
+			}
+		}
+		return res;
+	}
+
+	// Adds s to buckets crossed by b
+	void Shape_index::place(Shape* s, Box b)
+	{
+		if (b.empty()) return;		// Handle of empty box
+		const unsigned int c2 = col(b.x + static_cast<int>(b.w) - 1), r2 = row(b.y + static_cast<int>(b.h) - 1);
+		for (unsigned int r = row(b.y); r <= r2; ++r)
+			for (unsigned int c = col(b.x); c <= c2; ++c)
+				buckets[r * cols + c].push_back(s);
+	}
+
+	// Removes s from buckets crossed by b
+	void Shape_index::remove(Shape* s, Box b)
+	{
+		if (b.empty()) return;		// Handle of empty box
+		const unsigned int c2 = col(b.x + static_cast<int>(b.w) - 1), r2 = row(b.y + static_cast<int>(b.h) - 1);
+		for (unsigned int r = row(b.y); r <= r2; ++r)
+			for (unsigned int c = col(b.x); c <= c2; ++c) {
+				auto& bucket = buckets[r * cols + c];
+				bucket.erase(std::remove(bucket.begin(), bucket.end(), s), bucket.end());
+			}
+	}
+
+	// Determines column of bucket at x; border column is used for x out of area
+	unsigned int Shape_index::col(int x) const
+	{
+		return x < 0 ? 0 : std::min(static_cast<unsigned int>(x) / bucket_sz, cols - 1);
+	}
+
+	// Determines row of bucket at y; border row is used for y out of area
+	unsigned int Shape_index::row(int y) const
+	{
+		return y < 0 ? 0 : std::min(static_cast<unsigned int>(y) / bucket_sz, rows - 1);
 	}
 
 	//------------------------------------------------------------------------------
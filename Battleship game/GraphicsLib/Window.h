@@ -7,6 +7,11 @@
 
 #include <string>
 #include <vector>
+#include <list>
+#include <unordered_map>
+#include <map>
+#include <chrono>
+#include <functional>
 #include "fltk.h"
 #include "Point.h"
 
@@ -18,18 +23,68 @@ namespace Graph_lib {
 
 	class Shape;		// "Forward declare" of Shape
 	class Widget;		// "Forward declare" of Widget
+	class Painter;		// "Forward declare" of Painter
+
+	//------------------------------------------------------------------------------
+
+	// Invariant: bucket_sz > 0
+	// Note: area is split into buckets of bucket_sz * bucket_sz size, each of them keeps shapes
+	// crossing it; shapes out of area are kept in border buckets; boxes of shapes are
+	// taken on insert and update only, so index is stale after shape is changed until update
+	class Shape_index {		// Uniform grid of shapes' boxes, used to find shapes at points
+	public:
+		// Construction
+		Shape_index(unsigned int w, unsigned int h, unsigned int bucket_sz = 64);
+
+		// Access to parameters (writing)
+		void insert(Shape& s, unsigned int layer, unsigned int order);	// Add s, ranked by layer, then order
+		void erase(Shape& s);
+		void update(Shape& s);						// Move s to buckets of its current box
+		void set_order(Shape& s, unsigned int order);
+		void set_visibility(unsigned int layer, bool vis);	// Shapes of hidden layers aren't found
+
+		// Access to parameters (reading)
+		Shape* find(Point p) const;		// Visible shape of highest rank, box of which contains p
+		unsigned int size() const { return entries.size(); }
+
+	private:
+		struct Entry {		// Indexed shape
+			Box area;				// Box of shape when it was indexed
+			unsigned int layer;
+			unsigned int order;		// Rank of shape in its layer
+		};
+
+		std::unordered_map<Shape*, Entry> entries;	// Indexed shapes
+		std::vector<std::vector<Shape*>> buckets;	// Shapes crossing each bucket (by rows)
+		unsigned int bucket_sz;						// Size of each bucket
+		unsigned int cols, rows;					// Number of buckets
+		std::vector<bool> hidden;					// Hidden layers
+
+		// Helper functions
+		void place(Shape* s, Box b);		// Add s to buckets crossed by b
+		void remove(Shape* s, Box b);		// Remove s from buckets crossed by b
+		unsigned int col(int x) const;		// Column of bucket at x (clamped to area)
+		unsigned int row(int y) const;		// Row of bucket at y (clamped to area)
+	};
 
 	//------------------------------------------------------------------------------
 
 	// Invariant: w >= 0, h >= 0
+	// Note: shapes are drawn by layers, from background to overlays; background
+	// layer is drawn once and then copied until invalidate_static() is called
 	class Window : public Fl_Double_Window {
 	public:
+		enum class Layer {		// Layers of shapes, in order of drawing
+			background, boards, ships, overlays
+		};
+		static constexpr unsigned int layers = 4;	// Number of layers
+
 		// Construction
 		Window(unsigned int w, unsigned int h, const std::string& lab);		// Default location (xy)
 		Window(Point xy, unsigned int w, unsigned int h, const std::string& lab);
 
 		// Destruction
-		virtual ~Window() { }
+		virtual ~Window();
 
 		// Access to data
 		//void resize(unsigned int ww, unsigned int hh) { w = ww, h = hh; size(ww, hh); }
@@ -39,28 +94,73 @@ namespace Graph_lib {
 		std::string get_label() const { return std::string{ label() }; }
 
 		// Conection with with shapes and widgets
-		void attach(Shape& s);		// Add s to shapes
+		void attach(Shape& s, Layer l = Layer::boards);		// Add s on top of shapes of l
+		void attach_static(Shape& s) { attach(s, Layer::background); }	// Add s to shapes drawn once
 		void attach(Widget& w);		// Add w to window
 		void detach(Shape& s);		// Remove s from shapes 
 		void detach(Widget& w);		// Remove w from window
-		void put_on_top(Shape& p);	// Put p on top of other shapes
+		void put_on_top(Shape& p);	// Put p on top of other shapes of its layer
+		void move(Shape& s, int dx, int dy);	// Move s, keeping it at right place of index
+		// Update place of s in index after its box was changed; must be called after any change
+		// of attached shape not made by move() above (Shape::move, set_point, add, etc.),
+		// otherwise pick() answers by its old box
+		void reindex(Shape& s);
+
+		// Visibility of layers (shapes of hidden layers aren't drawn or picked)
+		void show_layer(Layer l) { set_layer_visibility(l, true); }
+		void hide_layer(Layer l) { set_layer_visibility(l, false); }
+		bool is_visible(Layer l) const { return shown[static_cast<unsigned int>(l)]; }
+
+		// Search of shapes
+		Shape* pick(Point xy) const;	// Topmost visible shape at xy; NULL if there's none
+
+		// Drawing of graphics
+		void invalidate(const Shape& s);	// Redraw area of s at next drawing
+		void invalidate(Box b);				// Redraw b at next drawing
+		void invalidate_static();			// Redraw static layer at next drawing
+		void render(Painter& p) const;		// Draw shapes of visible layers by p (without widgets)
+
+		// Timed actions (called by event loop)
+		void schedule(double delay, std::function<void()> act);		// Call act in delay seconds
+		void cancel_scheduled();			// Drop all scheduled actions
+
+		static constexpr double frame_time = 1.0 / 60;	// Least time between redrawings of invalidated areas
 
 	protected:
 		// Drawing of graphics
 		void draw();
 
 	private:
-		std::vector<Shape*> shapes;		// Attached shapes
+		typedef std::list<Shape*> Shapes;
+
+		Shapes scene[layers];			// Attached shapes of each layer, in order of drawing
+		std::unordered_map<Shape*, std::pair<Layer, Shapes::iterator>> places;	// Places of shapes in scene
+		bool shown[layers];				// Visibility of layers
+		// Static layer (drawing of background layer)
+		Fl_Offscreen layer;				// Drawing of static shapes
+		bool layer_valid;				// Drawing of static shapes is up to date
+		Box layer_area;					// Area covered by visible static shapes
 		unsigned int w, h;				// Width and height (size)
+		Shape_index index;				// Boxes of attached shapes
+		unsigned int top;				// Order of last shape put on top
+		std::vector<Box> damaged;		// Areas invalidated since last frame
+		std::multimap<std::chrono::steady_clock::time_point, std::function<void()>> actions;	// Scheduled actions by time
 
-		// Helper function
+		// Helper functions
 		void init();					// Initial parameters of window
+		void draw_static();				// Draw static layer, redraw it if needed
+		void set_layer_visibility(Layer l, bool vis);
+		void arm_timer();				// Wait for time of first scheduled action
+		static void cb_timer(void* win);	// Call actions, time of which has come
+		static void cb_frame(void* win);	// Damage areas invalidated since last frame
 	};
 
 	//------------------------------------------------------------------------------
 
 	// Helper functions
 	inline int gui_main() { return Fl::run(); }		// Invoke GUI library's main event loop
+	void set_headless(bool h);		// Windows constructed while headless aren't shown (can be rendered only)
+	bool is_headless();
 	inline unsigned int x_max() { return Fl::w(); }	// Width of screen in pixels
 	inline unsigned int y_max() { return Fl::h(); }	// Height of screen in pixels
 
@@ -9,6 +9,7 @@ using namespace Graph_lib;
 
 int main()
 {
+	Fl::lock();		// Enable posting of target's shots from worker thread (before any window)
 	// Game window with top-left angle at (100, 100), of
 	// size 1200 * 600, labeled with "Battleship game"
 	Battleship game{ Point{ 100, 100 }, 1200, 600, "Battleship game" };
@@ -0,0 +1,217 @@
+// Microbenchmarks of hot paths of game engine and rendering
+
+//------------------------------------------------------------------------------
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <map>
+#include <new>
+#include <cstdlib>
+#include <FL/x.H>
+#include "Game_GUI.h"
+#include "RandGenerator/Generator.h"
+using namespace Graph_lib;
+
+//------------------------------------------------------------------------------
+
+// Counting of allocations
+unsigned long long allocations = 0;
+
+void* operator new(std::size_t sz)
+{
+	++allocations;
+	if (void* p = std::malloc(sz ? sz : 1))
+		return p;
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+//------------------------------------------------------------------------------
+
+// Constants
+constexpr unsigned int cell_w = 50;		// Width of cells
+constexpr unsigned int cell_h = 50;		// Height of cells
+constexpr unsigned int num = 10;		// Number of cells in row and column
+constexpr double min_time = 0.05;		// Least time of run in seconds
+constexpr unsigned int runs = 5;		// Number of runs of benchmark, the fastest one counts
+constexpr double threshold = 1.1;		// Slowdown considered to be regression
+
+volatile unsigned long long sink = 0;	// Results of benchmarked operations
+
+//------------------------------------------------------------------------------
+
+struct Result {			// Result of benchmark
+	std::string name;
+	double ns;			// Nanoseconds per operation
+	double allocs;		// Allocations per operation
+};
+
+//------------------------------------------------------------------------------
+
+// Measures op called as op(i) for i = 0, 1, ...; number of calls is chosen to take at least min_time
+template<class F> Result measure(const std::string& name, F op)
+{
+	using Clock = std::chrono::steady_clock;
+	unsigned long long n = 1;
+	// Find number of calls
+	for (;; n *= 2) {
+		const auto start = Clock::now();
+		for (unsigned long long i = 0; i < n; ++i)
+			op(i);
+		if (std::chrono::duration<double>(Clock::now() - start).count() >= min_time)
+			break;
+	}
+	Result res{ name, 0, 0 };
+	for (unsigned int r = 0; r < runs; ++r) {
+		const unsigned long long allocs = allocations;
+		const auto start = Clock::now();
+		for (unsigned long long i = 0; i < n; ++i)
+			op(i);
+		const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / n;
+		if (r == 0 || ns < res.ns)
+			res.ns = ns;
+		res.allocs = static_cast<double>(allocations - allocs) / n;
+	}
+	return res;
+}
+
+//------------------------------------------------------------------------------
+
+class Scene : public Battleship {		// Game window, which can be drawn on demand
+public:
+	using Battleship::Battleship;
+	using Battleship::draw;
+};
+
+// Runs all benchmarks
+std::vector<Result> run_all()
+{
+	std::vector<Result> res;
+	const Point origin{ cell_w, cell_h };
+	Fleet fleet{ origin, cell_w * num, cell_h * num, cell_w, cell_h };
+	fleet.random_location();
+	// Points of top-left angles of all cells of frame
+	std::vector<Point> cells;
+	for (unsigned int i = 0; i < num * num; ++i)
+		cells.push_back(Point{ origin.x + static_cast<int>(cell_w * (i / num)), origin.y + static_cast<int>(cell_h * (i % num)) });
+	// Board with same ships as fleet
+	std::vector<Game_engine::Bitboard> ships(fleet.number_of_ships());
+	for (unsigned int i = 0; i < num * num; ++i)
+		if (fleet.board().owner(i) != Game_engine::Board::no_ship)
+			ships[fleet.board().owner(i)].set(i);
+	Game_engine::Board brd{ num, num };
+	for (const Game_engine::Bitboard& ship : ships)
+		brd.add_ship(ship);
+	res.push_back(measure("Board::shot", [&](unsigned long long i) {
+		if (i % (num * num) == 0)
+			brd.restore();
+		sink += static_cast<unsigned int>(brd.shot(i % (num * num)));
+	}));
+	res.push_back(measure("Fleet::shot", [&](unsigned long long i) {
+		if (i % (num * num) == 0)
+			fleet.restore();
+		sink += static_cast<unsigned int>(fleet.shot(cells[i % (num * num)]));
+	}));
+	fleet.restore();
+	res.push_back(measure("Fleet::random_location", [&](unsigned long long) {
+		fleet.random_location();
+	}));
+	res.push_back(measure("is_overlap", [&](unsigned long long i) {
+		sink += is_overlap(fleet[i % fleet.number_of_ships()], fleet[(i / fleet.number_of_ships()) % fleet.number_of_ships()]);
+	}));
+	res.push_back(measure("next_index", [&](unsigned long long i) {
+		sink += next_index(i % (num * num), static_cast<Direction>(i % 8));
+	}));
+	Grid grid{ origin, cell_w, cell_h, num, num };
+	res.push_back(measure("is_empty_cell", [&](unsigned long long i) {
+		sink += is_empty_cell(grid[i % (num * num)]);
+	}));
+	res.push_back(measure("Grid construction", [&](unsigned long long) {
+		Grid g{ origin, cell_w, cell_h, num, num };
+		sink += g.size();
+	}));
+	res.push_back(measure("Grid::width/height", [&](unsigned long long) {
+		sink += grid.width() + grid.height();
+	}));
+	// Drawing of game scene into offscreen buffer
+	fl_open_display();
+	Scene scene{ Point{ 100, 100 }, 1200, 600, "Battleship game" };
+	const Fl_Offscreen buf = fl_create_offscreen(scene.x_max(), scene.y_max());
+	res.push_back(measure("Window::draw (offscreen)", [&](unsigned long long) {
+		fl_begin_offscreen(buf);
+		scene.draw();
+		fl_end_offscreen();
+	}));
+	fl_delete_offscreen(buf);
+	return res;
+}
+
+//------------------------------------------------------------------------------
+
+// Reads last results of each benchmark from history, written as lines of "label,name,ns,allocs"
+std::map<std::string, Result> read_history(const std::string& path)
+{
+	std::map<std::string, Result> last;
+	std::ifstream ifs{ path };
+	for (std::string line; std::getline(ifs, line); ) {
+		std::istringstream iss{ line };
+		std::string label, name, ns, allocs;
+		if (std::getline(iss, label, ',') && std::getline(iss, name, ',') && std::getline(iss, ns, ',') &&
+			std::getline(iss, allocs))
+			last[name] = Result{ name, std::stod(ns), std::stod(allocs) };
+	}
+	return last;
+}
+
+//------------------------------------------------------------------------------
+
+// Arguments: file of history of results (appended with results of this run), label of run;
+// returns 2 if some benchmark became slower than in previous run by more than threshold
+int main(int argc, char* argv[])
+try {
+	const std::string path = argc > 1 ? argv[1] : "";
+	const std::string label = argc > 2 ? argv[2] : "run";
+	const std::map<std::string, Result> last = path.empty() ? std::map<std::string, Result>{} : read_history(path);
+	const std::vector<Result> res = run_all();
+	bool regression = false;
+	std::cout << std::left << std::setw(28) << "Benchmark" << std::right << std::setw(12) << "ns/op"
+		<< std::setw(12) << "allocs/op" << std::setw(12) << "change" << '\n' << std::fixed;
+	for (const Result& r : res) {
+		std::cout << std::left << std::setw(28) << r.name << std::right << std::setprecision(1) << std::setw(12) << r.ns
+			<< std::setprecision(2) << std::setw(12) << r.allocs;
+		const auto p = last.find(r.name);
+		if (p != last.end() && p->second.ns > 0) {
+			const double ratio = r.ns / p->second.ns;
+			std::cout << std::setprecision(1) << std::setw(11) << (ratio - 1) * 100 << '%';
+			if (ratio > threshold || r.allocs > p->second.allocs + 0.01) {
+				std::cout << "  regression";
+				regression = true;
+			}
+		}
+		std::cout << '\n';
+	}
+	if (!path.empty()) {
+		std::ofstream ofs{ path, std::ios_base::app };
+		for (const Result& r : res)
+			ofs << label << ',' << r.name << ',' << r.ns << ',' << r.allocs << '\n';
+	}
+	return regression ? 2 : 0;
+}
+catch (const std::exception& e) {
+	std::cerr << "Error: " << e.what() << '\n';
+	return 1;
+}
+
+//------------------------------------------------------------------------------
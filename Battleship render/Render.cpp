@@ -0,0 +1,100 @@
+// Headless rendering of game window into image
+
+//------------------------------------------------------------------------------
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <string>
+#include "Game_GUI.h"
+using namespace Graph_lib;
+
+//------------------------------------------------------------------------------
+
+// Constants (as in Game_GUI.cpp)
+constexpr int cell_w = 50;		// Width of cells
+constexpr int cell_h = 50;		// Height of cells
+constexpr int h_num = 10;		// Number of horizontal lines
+constexpr int x_offset = 100;	// Offset by x-coordinate between grids
+const Point player_xy{ cell_w, cell_h * 2 };							// Top-left angle of player field
+const Point target_xy{ cell_w * (h_num + 2) + x_offset, cell_h * 2 };	// Top-left angle of target field
+
+//------------------------------------------------------------------------------
+
+// Fails check with message msg unless cond holds
+void expect(bool cond, const std::string& msg)
+{
+	if (!cond)
+		throw std::logic_error(msg);
+}
+
+// Formats pixel p as hexadecimal bytes (red, green, blue, alpha)
+std::string hex(std::uint32_t p)
+{
+	const unsigned char* b = reinterpret_cast<const unsigned char*>(&p);
+	std::ostringstream os;
+	os << std::hex << std::setfill('0');
+	for (unsigned int i = 0; i < 4; ++i)
+		os << std::setw(2) << static_cast<unsigned int>(b[i]);
+	return os.str();
+}
+
+// Checks that pixel of r at xy has color c
+void expect_pixel(const Raster& r, Point xy, Color c, const std::string& what)
+{
+	const std::uint32_t p = r.pixel(xy.x, xy.y), q = as_pixel(c.as_int());
+	expect(p == q, what + ": pixel at " + to_string(xy) + " is " + hex(p) + ", expected " + hex(q));
+}
+
+// Counts pixels of r with color c in box b
+unsigned int count_pixels(const Raster& r, Box b, Color c)
+{
+	const std::uint32_t q = as_pixel(c.as_int());
+	unsigned int num = 0;
+	for (int y = b.y; y < b.y + static_cast<int>(b.h); ++y)
+		for (int x = b.x; x < b.x + static_cast<int>(b.w); ++x)
+			num += r.pixel(x, y) == q;
+	return num;
+}
+
+//------------------------------------------------------------------------------
+
+// Arguments: name of output image (binary PPM)
+int main(int argc, char* argv[])
+try {
+	using Clock = std::chrono::steady_clock;
+	const std::string name = argc > 1 ? argv[1] : "battleship.ppm";
+	set_headless(true);		// Game window isn't shown, so no display is needed
+	Battleship game{ Point{ 100, 100 }, 1200, 600, "Battleship game" };
+	Raster raster{ game.x_max(), game.y_max() };
+	const auto start = Clock::now();
+	game.render(raster);
+	const double time = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+	// Cells are empty at start of game, fleet of target is hidden and fleet of player isn't
+	expect_pixel(raster, Point{ target_xy.x + cell_w / 2, target_xy.y + cell_h / 2 }, Color::Color_type::blue,
+		"cell of target field");
+	expect_pixel(raster, Point{ target_xy.x, target_xy.y + cell_h / 2 }, Color::Color_type::black,
+		"frame of target field");
+	expect_pixel(raster, Point{ player_xy.x, player_xy.y + cell_h / 2 }, Color::Color_type::black,
+		"frame of player field");
+	const Box player_box{ player_xy, cell_w * h_num, cell_h * h_num };
+	const Box target_box{ target_xy, cell_w * h_num, cell_h * h_num };
+	expect(count_pixels(raster, player_box, Color::Color_type::white) > 0, "fleet of player isn't drawn");
+	expect(count_pixels(raster, target_box, Color::Color_type::white) == 0, "fleet of target isn't hidden");
+	// Output of image
+	std::ofstream os{ name, std::ios::binary };
+	if (!os)
+		throw std::runtime_error("Bad file: can't open " + name);
+	raster.write_ppm(os);
+	std::cout << "Rendered " << raster.width() << " * " << raster.height() << " in " << time << " us into "
+		<< name << '\n';
+	return 0;
+}
+catch (const std::exception& e) {
+	std::cerr << "Error: " << e.what() << '\n';
+	return 1;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,182 @@
+// Headless games between targeting strategies
+
+//------------------------------------------------------------------------------
+
+#include <iostream>
+#include <algorithm>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <exception>
+#include <string>
+#include "GameEngine/Monte_carlo.h"
+using namespace Game_engine;
+
+//------------------------------------------------------------------------------
+
+// Constants
+constexpr unsigned int cols = 10;		// Number of columns of field
+constexpr unsigned int rows = 10;		// Number of rows of field
+constexpr unsigned int chunk = 64;		// Number of games taken by thread at once
+const std::vector<unsigned int> classic{ 4, 3, 3, 2, 2, 2, 1, 1, 1, 1 };	// Classic fleet
+const std::string names = "random, hunt, density, monte-carlo";
+
+//------------------------------------------------------------------------------
+
+struct Statistics {		// Results of games of strategy
+	unsigned long long wins;
+	std::vector<unsigned long long> shots;		// Number of won games by number of shots
+};
+
+//------------------------------------------------------------------------------
+
+// Constructs targeting strategy called name, which uses ran; Monte Carlo strategy spends budget on each move
+std::unique_ptr<Targeting> make_targeting(const std::string& name, Placement::Engine& ran,
+	Monte_carlo_targeting::Clock::duration budget)
+{
+	if (name == "random")
+		return std::make_unique<Random_targeting>(cols, rows, ran);
+	if (name == "hunt")
+		return std::make_unique<Hunt_targeting>(cols, rows, ran);
+	if (name == "density")
+		return std::make_unique<Density_targeting>(cols, rows, ran);
+	if (name == "monte-carlo")		// Games are parallel already, so moves aren't
+		return std::make_unique<Monte_carlo_targeting>(cols, rows, ran, budget, 1);
+	throw std::invalid_argument("Bad strategy: " + name + " (expected " + names + ")");
+}
+
+// Locates fleet randomly on board, as Fleet::random_location does
+void random_fleet(const Placement& plc, Board& brd, std::vector<Ship_position>& pos, Placement::Engine& ran)
+{
+	if (!plc.random_layout(classic, pos, ran))
+		throw std::runtime_error("Bad field: no room to locate ships");
+	brd.clear_ships();
+	brd.restore();
+	for (unsigned int i = 0; i < classic.size(); ++i)
+		brd.add_ship(plc.cells(classic[i], pos[i].orient, pos[i].anchor));
+}
+
+// Plays game of strategies ai against fleets of their opponents in brd, starting with ai[first];
+// the one who hitted continues shooting; returns index of winner and number of its shots in shots
+unsigned int play(Targeting* ai[2], Board* brd[2], unsigned int first, unsigned int& shots)
+{
+	unsigned int num[2] = { 0, 0 };		// Number of shots of each strategy
+	for (unsigned int turn = first; ; ) {
+		const unsigned int i = ai[turn]->choose();
+		const Shot_result res = brd[turn]->shot(i);
+		ai[turn]->report(i, res);
+		if (++num[turn] > cols * rows)		// Handle of strategy shooting at same cells
+			throw std::runtime_error("Bad strategy: too many shots");
+		if (brd[turn]->is_sunk()) {
+			shots = num[turn];
+			return turn;
+		}
+		if (res == Shot_result::miss)		// Pass turn to opponent
+			turn = 1 - turn;
+	}
+}
+
+// Plays games taken from next until games are played; each strategy shoots first in every other game;
+// exception is kept in error (to be rethrown by main thread), and other threads stop taking games
+void run(const std::string name[2], unsigned long long games, Monte_carlo_targeting::Clock::duration budget,
+	Placement::Engine::result_type seed, std::atomic<unsigned long long>& next, Statistics stats[2],
+	std::exception_ptr& error)
+try {
+	Placement::Engine ran{ seed };
+	const Placement plc{ cols, rows };
+	std::unique_ptr<Targeting> strategy[2] = { make_targeting(name[0], ran, budget), make_targeting(name[1], ran, budget) };
+	Targeting* ai[2] = { strategy[0].get(), strategy[1].get() };
+	Board fleet[2] = { Board{ cols, rows }, Board{ cols, rows } };
+	Board* brd[2] = { &fleet[1], &fleet[0] };		// Fleet of opponent of each strategy
+	std::vector<Ship_position> pos;
+	for (unsigned long long g = next.fetch_add(chunk); g < games; g = next.fetch_add(chunk))
+		for (unsigned long long end = std::min(g + chunk, games); g < end; ++g) {
+			for (unsigned int k = 0; k < 2; ++k) {
+				random_fleet(plc, fleet[k], pos, ran);
+				ai[k]->reset(classic);
+			}
+			unsigned int shots = 0;
+			const unsigned int winner = play(ai, brd, g % 2, shots);
+			++stats[winner].wins;
+			++stats[winner].shots[shots];
+		}
+}
+catch (...) {
+	error = std::current_exception();
+	next = games;
+}
+
+// Determines least number of shots, within which p of won games are won
+unsigned int percentile(const std::vector<unsigned long long>& shots, unsigned long long wins, double p)
+{
+	unsigned long long num = 0;
+	for (unsigned int i = 0; i < shots.size(); ++i)
+		if ((num += shots[i]) >= p * wins && num > 0)
+			return i;
+	return 0;
+}
+
+// Prints results of strategy called name
+void report(const std::string& name, const Statistics& stats, unsigned long long games)
+{
+	double mean = 0;
+	for (unsigned int i = 0; i < stats.shots.size(); ++i)
+		mean += static_cast<double>(stats.shots[i]) * i;
+	mean = stats.wins ? mean / stats.wins : 0;
+	std::cout << "  " << std::left << std::setw(12) << name << std::right << " wins " << std::setw(6) << std::fixed
+		<< std::setprecision(2) << 100.0 * stats.wins / games << "%, shots to win: mean " << mean << ", p50 "
+		<< percentile(stats.shots, stats.wins, 0.5) << ", p90 " << percentile(stats.shots, stats.wins, 0.9)
+		<< ", p99 " << percentile(stats.shots, stats.wins, 0.99) << '\n';
+}
+
+//------------------------------------------------------------------------------
+
+// Arguments: number of games, two strategies, number of threads (all cores if 0),
+// time budget of Monte Carlo move in microseconds, seed
+int main(int argc, char* argv[])
+try {
+	using Clock = std::chrono::steady_clock;
+	const unsigned long long games = argc > 1 ? std::stoull(argv[1]) : 100000;
+	const std::string name[2] = { argc > 2 ? argv[2] : "density", argc > 3 ? argv[3] : "hunt" };
+	unsigned int threads = argc > 4 ? std::stoul(argv[4]) : 0;
+	const std::chrono::microseconds budget{ argc > 5 ? std::stoul(argv[5]) : 1000 };
+	const Placement::Engine::result_type seed = argc > 6 ? std::stoul(argv[6]) : 2020;
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	Placement::Engine ran;
+	for (const std::string& n : name)		// Check names before starting threads
+		make_targeting(n, ran, budget);
+	// Play games in parallel
+	std::vector<Statistics> stats(threads * 2, Statistics{ 0, std::vector<unsigned long long>(cols * rows + 1, 0) });
+	std::atomic<unsigned long long> next{ 0 };
+	std::vector<std::thread> pool;
+	std::vector<std::exception_ptr> errors(threads);		// Exceptions thrown by threads
+	const auto start = Clock::now();
+	for (unsigned int t = 0; t < threads; ++t)
+		pool.emplace_back(run, name, games, budget, seed + t, std::ref(next), &stats[t * 2], std::ref(errors[t]));
+	for (std::thread& t : pool)
+		t.join();
+	for (const std::exception_ptr& e : errors)
+		if (e)
+			std::rethrow_exception(e);
+	const double time = std::chrono::duration<double>(Clock::now() - start).count();
+	// Merge results of threads
+	for (unsigned int t = 1; t < threads; ++t)
+		for (unsigned int k = 0; k < 2; ++k) {
+			stats[k].wins += stats[t * 2 + k].wins;
+			for (unsigned int i = 0; i < stats[k].shots.size(); ++i)
+				stats[k].shots[i] += stats[t * 2 + k].shots[i];
+		}
+	std::cout << games << " games, " << threads << " threads, " << time << " s, " << games / time << " games/s\n";
+	report(name[0], stats[0], games);
+	report(name[1], stats[1], games);
+	return 0;
+}
+catch (const std::exception& e) {
+	std::cerr << "Error: " << e.what() << '\n';
+	return 1;
+}
+
+//------------------------------------------------------------------------------
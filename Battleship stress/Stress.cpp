@@ -0,0 +1,335 @@
+// Stress test of fleet placement and shot resolution on random frames, and of
+// placement of random fleets on tight fields
+
+//------------------------------------------------------------------------------
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "Game_graph.h"
+using namespace Graph_lib;
+using Engine = Game_engine::Placement::Engine;
+
+//------------------------------------------------------------------------------
+
+// Constants
+constexpr unsigned int num_of_ships = 10;	// Least number of cells in row and column of frame
+constexpr unsigned int max_cells = 12;		// Greatest number of cells in row and column of frame
+constexpr unsigned int max_cell = 100;		// Greatest size of cell
+constexpr unsigned int min_side = 6;		// Least number of cells in row and column of tight field
+constexpr unsigned int max_side = 9;		// Greatest number of cells in row and column of tight field
+constexpr unsigned int max_len = 4;			// Greatest length of ship of random fleet
+constexpr double min_load = 0.4;			// Least load of tight field by random fleet
+constexpr double max_load = 0.7;			// Greatest load (backtracking grows exponentially above it)
+constexpr unsigned int buckets = 64;		// Number of buckets of histograms (powers of 2)
+constexpr unsigned int max_failures = 10;	// Number of failures to print
+constexpr unsigned long long chunk = 256;	// Number of cases taken by thread at once
+
+//------------------------------------------------------------------------------
+
+struct Distribution {	// Latency and retries of placements
+	std::vector<unsigned long long> latency;	// Number of placements by log2 of time in nanoseconds
+	std::vector<unsigned long long> retries;	// Number of placements by log2 of number of retries + 1
+	unsigned long long max_latency;				// Nanoseconds
+	unsigned long long max_retries;
+
+	void add(unsigned long long ns, unsigned long long re);
+	void merge(const Distribution& d);
+};
+
+struct Statistics {		// Results of cases of thread
+	Distribution fleets;		// Placements of classic fleet on random frames
+	Distribution layouts;		// Placements of random fleets on tight fields
+	unsigned long long no_room;	// Number of random fleets which have no layout
+	unsigned long long shots;
+	unsigned long long failures;
+};
+
+//------------------------------------------------------------------------------
+
+// Determines index of bucket of histogram for value v
+unsigned int bucket(unsigned long long v)
+{
+	unsigned int b = 0;
+	for (; v > 1 && b + 1 < buckets; v >>= 1)
+		++b;
+	return b;
+}
+
+// Determines least upper bound of bucket of histogram h, which includes p of its values
+unsigned long long percentile(const std::vector<unsigned long long>& h, double p)
+{
+	unsigned long long total = 0, num = 0;
+	for (unsigned long long n : h)
+		total += n;
+	for (unsigned int b = 0; b < h.size(); ++b)
+		if ((num += h[b]) >= p * total && num > 0)
+			return (2ull << b) - 1;
+	return 0;
+}
+
+// Adds placement which took ns nanoseconds and re retries
+void Distribution::add(unsigned long long ns, unsigned long long re)
+{
+	++latency[bucket(ns)];
+	++retries[bucket(re + 1)];
+	max_latency = std::max(max_latency, ns);
+	max_retries = std::max(max_retries, re);
+}
+
+// Adds placements of d
+void Distribution::merge(const Distribution& d)
+{
+	for (unsigned int b = 0; b < buckets; ++b) {
+		latency[b] += d.latency[b];
+		retries[b] += d.retries[b];
+	}
+	max_latency = std::max(max_latency, d.max_latency);
+	max_retries = std::max(max_retries, d.max_retries);
+}
+
+// Prints percentiles and histograms of placements d called name
+void print(const std::string& name, const Distribution& d)
+{
+	std::cout << name << " latency (ns): p50 <= " << percentile(d.latency, 0.5) << ", p99 <= "
+		<< percentile(d.latency, 0.99) << ", p99.9 <= " << percentile(d.latency, 0.999)
+		<< ", max " << d.max_latency << '\n'
+		<< name << " retries: p50 < " << percentile(d.retries, 0.5) << ", p99 < " << percentile(d.retries, 0.99)
+		<< ", p99.9 < " << percentile(d.retries, 0.999) << ", max " << d.max_retries << '\n'
+		<< "Latency histogram (ns):\n";
+	for (unsigned int b = 0; b < buckets; ++b)
+		if (d.latency[b])
+			std::cout << "  [" << std::setw(12) << (1ull << b) << ", " << std::setw(12) << (2ull << b) << ") "
+				<< d.latency[b] << '\n';
+	std::cout << "Retries histogram:\n";
+	for (unsigned int b = 0; b < buckets; ++b)
+		if (d.retries[b])
+			std::cout << "  [" << std::setw(12) << ((1ull << b) - 1) << ", " << std::setw(12) << ((2ull << b) - 1) << ") "
+				<< d.retries[b] << '\n';
+}
+
+// Fails check with message msg unless cond holds
+void expect(bool cond, const std::string& msg)
+{
+	if (!cond)
+		throw std::logic_error(msg);
+}
+
+//------------------------------------------------------------------------------
+
+// Checks that ships of fleet are inside frame of cols * rows cells of cell_w * cell_h with top-left angle at xy,
+// aren't overlapped by each other, have cells at positions of cells of frame, and are marked on board
+void check_location(const Fleet& fleet, Point xy, int cols, int rows, int cell_w, int cell_h)
+{
+	const Game_engine::Board& brd = fleet.board();
+	for (unsigned int i = 0; i < fleet.number_of_ships(); ++i) {
+		const Ship& ship = fleet[i];
+		for (unsigned int j = 0; j < static_cast<unsigned int>(ship.ship_kind()); ++j) {
+			const Point p = ship[j].point(0);
+			const int dx = p.x - xy.x, dy = p.y - xy.y;
+			expect(dx >= 0 && dy >= 0 && dx + cell_w <= cols * cell_w && dy + cell_h <= rows * cell_h,
+				"ship " + std::to_string(i) + " is out of frame");
+			expect(dx % cell_w == 0 && dy % cell_h == 0, "cell of ship " + std::to_string(i) + " isn't aligned to grid");
+			expect(brd.owner(brd.index(dx / cell_w, dy / cell_h)) == i,
+				"cell of ship " + std::to_string(i) + " isn't marked on board");
+			if (j > 0) {	// Cells go one after another in direction of orientation
+				const Point q = ship[j - 1].point(0);
+				expect(ship.orientation() == Ship::Orientation::horizontal ? p.x - q.x == cell_w && p.y == q.y :
+					p.y - q.y == cell_h && p.x == q.x, "cells of ship " + std::to_string(i) + " aren't consecutive");
+			}
+		}
+		for (unsigned int j = 0; j < i; ++j)
+			expect(!is_overlap(ship, fleet[j]), "ships " + std::to_string(j) + " and " + std::to_string(i) + " overlap");
+	}
+}
+
+// Checks results of shots at vertices of ships' cells, at spaces of cells, at empty cells and out of frame;
+// returns number of shots
+unsigned long long check_shots(Fleet& fleet, Point xy, int cols, int rows, int cell_w, int cell_h, Engine& ran)
+{
+	using State = Ship_cell::State;
+	const Game_engine::Board& brd = fleet.board();
+	unsigned long long shots = 0;
+	std::uniform_int_distribution<int> col{ 0, cols - 1 }, row{ 0, rows - 1 };
+	const Point cell{ xy.x + col(ran) * cell_w, xy.y + row(ran) * cell_h };
+	const bool occupied = brd.owner(brd.index((cell.x - xy.x) / cell_w, (cell.y - xy.y) / cell_h)) != brd.no_ship;
+	// Shot at space of cell except of vertex
+	if (cell_w > 1 || cell_h > 1) {
+		const Point space{ cell.x + std::uniform_int_distribution<int>{ cell_w > 1, cell_w - 1 }(ran),
+			cell.y + std::uniform_int_distribution<int>{ cell_h > 1 && cell_w == 1, cell_h - 1 }(ran) };
+		expect(fleet.shot(space) == State::miss, "shot at space of cell isn't miss");
+		++shots;
+	}
+	// Shot at vertex of empty cell
+	if (!occupied) {
+		expect(fleet.shot(cell) == State::miss, "shot at empty cell isn't miss");
+		++shots;
+	}
+	// Shots out of frame
+	expect(fleet.shot(Point{ xy.x - cell_w, cell.y }) == State::miss, "shot left of frame isn't miss");
+	expect(fleet.shot(Point{ cell.x, xy.y + rows * cell_h }) == State::miss, "shot below frame isn't miss");
+	shots += 2;
+	// Shots at vertices of all cells of random ship
+	const unsigned int i = std::uniform_int_distribution<unsigned int>{ 0, fleet.number_of_ships() - 1 }(ran);
+	const unsigned int len = static_cast<unsigned int>(fleet[i].ship_kind());
+	for (unsigned int j = 0; j < len; ++j) {
+		const State res = fleet.shot(fleet[i][j].point(0));
+		expect(res == (j + 1 < len ? State::hit : State::sunk), "shot at vertex of ship " + std::to_string(i) +
+			" isn't " + (j + 1 < len ? "hit" : "sunk"));
+		++shots;
+	}
+	expect(fleet[i].is_sunk(), "ship " + std::to_string(i) + " isn't sunk");
+	fleet.restore();
+	expect(!fleet[i].is_sunk() && !fleet.is_sunk(), "restored fleet is sunk");
+	return shots;
+}
+
+// Checks that ships of lengths lens at positions pos lie inside field of plc and don't touch each other
+void check_layout(const Game_engine::Placement& plc, const std::vector<unsigned int>& lens,
+	const std::vector<Game_engine::Ship_position>& pos)
+{
+	expect(pos.size() == lens.size(), "layout has wrong number of ships");
+	std::vector<Game_engine::Bitboard> cells(lens.size());
+	for (unsigned int i = 0; i < lens.size(); ++i) {
+		expect(plc.legal(lens[i], pos[i].orient, Game_engine::Bitboard{}).test(pos[i].anchor),
+			"ship " + std::to_string(i) + " is out of field");
+		cells[i] = plc.cells(lens[i], pos[i].orient, pos[i].anchor);
+		for (unsigned int j = 0; j < i; ++j)
+			expect((plc.halo(cells[j]) & cells[i]).none(), "ships " + std::to_string(j) + " and " +
+				std::to_string(i) + " touch each other");
+	}
+}
+
+// Locates random fleet on tight field directly by placement, measures placement and checks layout;
+// load of field is part of (cols + 1) * (rows + 1) cells covered by ships with their right and bottom
+// sides of around areas, which don't overlap each other in any layout (so there is no layout above 1)
+void run_layout_case(Engine& ran, Statistics& stats)
+{
+	using Clock = std::chrono::steady_clock;
+	std::uniform_int_distribution<unsigned int> side{ min_side, max_side }, len{ 1, max_len };
+	const unsigned int cols = side(ran), rows = side(ran);
+	const Game_engine::Placement plc{ cols, rows };
+	const double room = std::uniform_real_distribution<double>{ min_load, max_load }(ran) * (cols + 1) * (rows + 1);
+	std::vector<unsigned int> lens;
+	for (unsigned int load = 0, l = len(ran); load + (l + 1) * 2 <= room; l = len(ran)) {
+		lens.push_back(l);
+		load += (l + 1) * 2;
+	}
+	std::sort(lens.rbegin(), lens.rend());		// Largest ships first, as in fleet
+	// Placement
+	std::vector<Game_engine::Ship_position> pos;
+	unsigned long long retries = 0;
+	const auto start = Clock::now();
+	const bool placed = plc.random_layout(lens, pos, ran, &retries);
+	const unsigned long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+	stats.layouts.add(ns, retries);
+	if (placed)
+		check_layout(plc, lens, pos);
+	else
+		++stats.no_room;
+}
+
+// Runs case k using seed: locates fleet on random frame (even cases) or random fleet on tight field (odd cases),
+// measures placement and checks invariants
+void run_case(unsigned long long k, Engine::result_type seed, Statistics& stats)
+{
+	using Clock = std::chrono::steady_clock;
+	std::seed_seq seq{ seed, static_cast<Engine::result_type>(k), static_cast<Engine::result_type>(k >> 32) };
+	Engine ran{ seq };
+	if (k % 2) {
+		run_layout_case(ran, stats);
+		return;
+	}
+	// Frame of random size, which may be not multiple of cell
+	std::uniform_int_distribution<int> cell{ 1, max_cell }, cells{ 1, max_cells }, offset{ -1000, 1000 };
+	const int cell_w = cell(ran), cell_h = cell(ran);
+	int ww = 0, hh = 0, cols = 0, rows = 0;
+	do {
+		ww = cells(ran) * cell_w + std::uniform_int_distribution<int>{ 0, cell_w - 1 }(ran);
+		hh = cells(ran) * cell_h + std::uniform_int_distribution<int>{ 0, cell_h - 1 }(ran);
+		// Too small frame is enlarged by fleet
+		cols = std::max(ww / cell_w, static_cast<int>(num_of_ships));
+		rows = std::max(hh / cell_h, static_cast<int>(num_of_ships));
+	} while (cols * rows > static_cast<int>(Game_engine::Bitboard::capacity));
+	const Point xy{ offset(ran), offset(ran) };
+	Fleet fleet{ xy, static_cast<unsigned int>(ww), static_cast<unsigned int>(hh),
+		static_cast<unsigned int>(cell_w), static_cast<unsigned int>(cell_h) };
+	expect(fleet.frame_width() / cell_w == cols && fleet.frame_height() / cell_h == rows, "frame has wrong size");
+	// Placement
+	const auto start = Clock::now();
+	const unsigned long long retries = fleet.random_location(ran);
+	const unsigned long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+	stats.fleets.add(ns, retries);
+	check_location(fleet, xy, cols, rows, cell_w, cell_h);
+	stats.shots += check_shots(fleet, xy, cols, rows, cell_w, cell_h, ran);
+}
+
+// Runs cases taken from next until cases are run; prints failures
+void run(unsigned long long cases, Engine::result_type seed, std::atomic<unsigned long long>& next,
+	std::mutex& out, Statistics& stats)
+{
+	for (unsigned long long k = next.fetch_add(chunk); k < cases; k = next.fetch_add(chunk))
+		for (unsigned long long end = std::min(k + chunk, cases); k < end; ++k)
+			try {
+				run_case(k, seed, stats);
+			}
+			catch (const std::exception& e) {
+				std::lock_guard<std::mutex> lock{ out };
+				if (stats.failures++ < max_failures)
+					std::cout << "  case " << k << " failed: " << e.what() << '\n';
+			}
+}
+
+//------------------------------------------------------------------------------
+
+// Arguments: number of cases, number of threads (all cores if 0), seed;
+// cases are reproducible by seed and number of case
+int main(int argc, char* argv[])
+try {
+	using Clock = std::chrono::steady_clock;
+	const unsigned long long cases = argc > 1 ? std::stoull(argv[1]) : 1000000;
+	unsigned int threads = argc > 2 ? std::stoul(argv[2]) : 0;
+	const Engine::result_type seed = argc > 3 ? std::stoul(argv[3]) : 2020;
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	const Distribution empty{ std::vector<unsigned long long>(buckets, 0), std::vector<unsigned long long>(buckets, 0),
+		0, 0 };
+	std::vector<Statistics> stats(threads, Statistics{ empty, empty, 0, 0, 0 });
+	std::atomic<unsigned long long> next{ 0 };
+	std::mutex out;
+	std::vector<std::thread> pool;
+	const auto start = Clock::now();
+	for (unsigned int t = 0; t < threads; ++t)
+		pool.emplace_back(run, cases, seed, std::ref(next), std::ref(out), std::ref(stats[t]));
+	for (std::thread& t : pool)
+		t.join();
+	const double time = std::chrono::duration<double>(Clock::now() - start).count();
+	// Merge results of threads
+	Statistics& total = stats.front();
+	for (unsigned int t = 1; t < threads; ++t) {
+		total.fleets.merge(stats[t].fleets);
+		total.layouts.merge(stats[t].layouts);
+		total.no_room += stats[t].no_room;
+		total.shots += stats[t].shots;
+		total.failures += stats[t].failures;
+	}
+	std::cout << cases << " cases, " << total.shots << " shots, " << threads << " threads, " << time << " s, "
+		<< total.failures << " failures\n";
+	print("Fleet placement", total.fleets);
+	std::cout << "Tight fields (" << min_side << " * " << min_side << " to " << max_side << " * " << max_side
+		<< ", load " << min_load << " to " << max_load << "), " << total.no_room << " fleets without room\n";
+	print("Layout placement", total.layouts);
+	return total.failures ? 1 : 0;
+}
+catch (const std::exception& e) {
+	std::cerr << "Error: " << e.what() << '\n';
+	return 1;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,61 @@
+// Exact count of legal fleet layouts and of layouts occupying each cell
+
+//------------------------------------------------------------------------------
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <future>
+#include <string>
+#include "GameEngine/Enumerator.h"
+using namespace Game_engine;
+
+//------------------------------------------------------------------------------
+
+// Prints number of layouts occupying each cell of field cols * rows, row by row
+void print_cells(const std::vector<unsigned long long>& cells, unsigned int cols, unsigned int rows)
+{
+	for (unsigned int row = 0; row < rows; ++row) {
+		for (unsigned int col = 0; col < cols; ++col)
+			std::cout << std::setw(20) << cells[col * rows + row];
+		std::cout << '\n';
+	}
+}
+
+//------------------------------------------------------------------------------
+
+// Arguments: columns, rows, number of threads (all cores if 0), lengths of ships;
+// without arguments classic fleet of 10x10 field is enumerated on all cores
+int main(int argc, char* argv[])
+try {
+	using Clock = std::chrono::steady_clock;
+	const unsigned int cols = argc > 1 ? std::stoul(argv[1]) : 10;
+	const unsigned int rows = argc > 2 ? std::stoul(argv[2]) : 10;
+	const unsigned int threads = argc > 3 ? std::stoul(argv[3]) : 0;
+	std::vector<unsigned int> lens;
+	for (int i = 4; i < argc; ++i)
+		lens.push_back(std::stoul(argv[i]));
+	if (lens.empty())
+		lens = { 4, 3, 3, 2, 2, 2, 1, 1, 1, 1 };	// Classic fleet
+	const Placement plc{ cols, rows };
+	Layout_enumerator enumerator{ plc, lens };
+	std::cout << "Field " << cols << 'x' << rows << ", " << lens.size() << " ships, " << enumerator.symmetries()
+		<< " symmetries, " << enumerator.number_of_tasks() << " tasks" << std::endl;
+	const auto start = Clock::now();
+	std::future<Layout_count> res = std::async(std::launch::async, [&] { return enumerator.run(threads); });
+	// Report progress once a minute
+	while (res.wait_for(std::chrono::minutes(1)) != std::future_status::ready)
+		std::cout << "  " << enumerator.tasks_done() << '/' << enumerator.number_of_tasks() << " tasks done, "
+			<< std::chrono::duration<double>(Clock::now() - start).count() << " s" << std::endl;
+	const Layout_count count = res.get();
+	std::cout << "Layouts: " << count.layouts << "\nLayouts occupying each cell:\n";
+	print_cells(count.cells, cols, rows);
+	std::cout << "Time: " << std::chrono::duration<double>(Clock::now() - start).count() << " s\n";
+	return 0;
+}
+catch (const std::exception& e) {
+	std::cerr << "Error: " << e.what() << '\n';
+	return 1;
+}
+
+//------------------------------------------------------------------------------